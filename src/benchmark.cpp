@@ -17,13 +17,14 @@ struct BenchmarkResults {
     double objectModificationTime;
     double functionExecutionTime;
     double jsonSerializationTime;
+    double jsonStringSerializationTime;
     int totalIterations;
 };
 
 std::atomic<int> globalIterationCount(0);
 
 BenchmarkResults runBenchmark(V8EngineManager& manager, int iterations, bool verbose = false) {
-    BenchmarkResults results = {0, 0, 0, 0, iterations};
+    BenchmarkResults results = {0, 0, 0, 0, 0, iterations};
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> distrib(1, 1000);
@@ -83,10 +84,16 @@ BenchmarkResults runBenchmark(V8EngineManager& manager, int iterations, bool ver
 
         // Step 4: Serialize to JSON
         start = std::chrono::high_resolution_clock::now();
-        nlohmann::json json = result->ToJson();
+        std::string json = result->ToJson().dump();
         end = std::chrono::high_resolution_clock::now();
         results.jsonSerializationTime += std::chrono::duration<double, std::milli>(end - start).count();
 
+        // Same result through JSON.stringify, for comparison only (not part of the iteration total)
+        start = std::chrono::high_resolution_clock::now();
+        std::string jsonString = result->ToJsonString();
+        end = std::chrono::high_resolution_clock::now();
+        results.jsonStringSerializationTime += std::chrono::duration<double, std::milli>(end - start).count();
+
         ++globalIterationCount;
     }
 
@@ -94,12 +101,13 @@ BenchmarkResults runBenchmark(V8EngineManager& manager, int iterations, bool ver
 }
 
 void printResults(const std::vector<BenchmarkResults>& allResults) {
-    BenchmarkResults totalResults = {0, 0, 0, 0, 0};
+    BenchmarkResults totalResults = {0, 0, 0, 0, 0, 0};
     for (const auto& result : allResults) {
         totalResults.objectCreationTime += result.objectCreationTime;
         totalResults.objectModificationTime += result.objectModificationTime;
         totalResults.functionExecutionTime += result.functionExecutionTime;
         totalResults.jsonSerializationTime += result.jsonSerializationTime;
+        totalResults.jsonStringSerializationTime += result.jsonStringSerializationTime;
         totalResults.totalIterations += result.totalIterations;
     }
 
@@ -122,6 +130,9 @@ void printResults(const std::vector<BenchmarkResults>& allResults) {
               << (totalResults.functionExecutionTime / totalTime * 100) << "%)" << std::endl;
     std::cout << "JSON Serialization: " << totalResults.jsonSerializationTime << " ms ("
               << (totalResults.jsonSerializationTime / totalTime * 100) << "%)" << std::endl;
+    std::cout << "\nComparison:" << std::endl;
+    std::cout << "ToJson().dump(): " << totalResults.jsonSerializationTime << " ms" << std::endl;
+    std::cout << "ToJsonString(): " << totalResults.jsonStringSerializationTime << " ms" << std::endl;
 }
 
 int main() {
@@ -0,0 +1,419 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#undef _ITERATOR_DEBUG_LEVEL
+#define _ITERATOR_DEBUG_LEVEL 0
+#include "V8EngineManager.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <iomanip>
+#include <algorithm>
+
+template<typename Fn>
+double measureAverageMs(int iterations, Fn &&fn) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn(i);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+void printMeasurement(const std::string& label, double averageMs) {
+    std::cout << std::left << std::setw(48) << label << std::right << std::fixed << std::setprecision(4)
+              << averageMs << " ms" << std::endl;
+}
+
+// ExecuteJS used to re-expose every registered callback before each run, so its cost grew with the callback count.
+void benchmarkExecuteWithCallbacks(V8EngineManager& manager) {
+    const int callbackCount = 50;
+    const int iterations = 10000;
+    auto engine = manager.getEngine();
+
+    printMeasurement("ExecuteJS, no callbacks", measureAverageMs(iterations, [&](int) {
+        engine.get()->ExecuteJS("1 + 1");
+    }));
+
+    for (int i = 0; i < callbackCount; ++i) {
+        engine.get()->RegisterCallback("callback" + std::to_string(i), [](const v8::FunctionCallbackInfo<v8::Value>&) {});
+    }
+
+    printMeasurement("ExecuteJS, " + std::to_string(callbackCount) + " callbacks", measureAverageMs(iterations, [&](int) {
+        engine.get()->ExecuteJS("1 + 1");
+    }));
+}
+
+void addNumbersSlow(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Local<v8::Context> context = args.GetIsolate()->GetCurrentContext();
+    double a = args[0]->NumberValue(context).FromMaybe(0.0);
+    double b = args[1]->NumberValue(context).FromMaybe(0.0);
+    args.GetReturnValue().Set(a + b);
+}
+
+double addNumbersFast(v8::Local<v8::Object> receiver, double a, double b) {
+    return a + b;
+}
+
+// Only optimized code takes the fast path, so the loop is long enough for TurboFan to kick in.
+void benchmarkFastApiCallback(V8EngineManager& manager) {
+    const int calls = 10000000;
+    auto engine = manager.getEngine();
+    static const v8::CFunction fastAdd = v8::CFunction::Make(addNumbersFast);
+    engine.get()->RegisterCallback("addSlow", addNumbersSlow);
+    engine.get()->RegisterCallback("addFast", addNumbersSlow, fastAdd);
+
+    for (const std::string name : {"addSlow", "addFast"}) {
+        const std::string source = "(function() { let sum = 0; for (let i = 0; i < " + std::to_string(calls) +
+                                   "; ++i) { sum = " + name + "(sum, i); } return sum; })()";
+        double totalMs = measureAverageMs(1, [&](int) {
+            engine.get()->ExecuteJS(source);
+        });
+        printMeasurement(name + ", per 1M calls", totalMs / calls * 1000000);
+    }
+}
+
+nlohmann::json makePayload(size_t targetBytes) {
+    nlohmann::json payload = nlohmann::json::array();
+    size_t bytes = 2;
+    for (int i = 0; bytes < targetBytes; ++i) {
+        nlohmann::json record = {{"id", i}, {"name", "record " + std::to_string(i)}, {"active", i % 2 == 0},
+                                 {"values", {i, i * 0.5, -i}}};
+        bytes += record.dump().size() + 1;
+        payload.push_back(std::move(record));
+    }
+    return payload;
+}
+
+void benchmarkJsonConstruction(V8EngineManager& manager) {
+    auto engine = manager.getEngine();
+    for (size_t size : {size_t(1) << 10, size_t(100) << 10, size_t(1) << 20, size_t(10) << 20}) {
+        const nlohmann::json payload = makePayload(size);
+        const std::string text = payload.dump();
+        const int iterations = size >= (size_t(1) << 20) ? 10 : 200;
+        const std::string suffix = " (" + std::to_string(text.size() / 1024) + " KB)";
+
+        printMeasurement("CreateJSValue" + suffix, measureAverageMs(iterations, [&](int) {
+            engine.get()->CreateJSValue(text);
+        }));
+        printMeasurement("CreateJSValueFromJsonText" + suffix, measureAverageMs(iterations, [&](int) {
+            engine.get()->CreateJSValueFromJsonText(text);
+        }));
+        printMeasurement("CreateJSValueFromJson" + suffix, measureAverageMs(iterations, [&](int) {
+            engine.get()->CreateJSValueFromJson(payload);
+        }));
+    }
+}
+
+// Tight Get/Set loops; a PropertyKey skips creating and internalizing the name string on every access.
+void benchmarkPropertyAccess(V8EngineManager& manager) {
+    const int iterations = 100000;
+    auto engine = manager.getEngine();
+    auto object = engine.get()->CreateJSValue("{ counter: 0 }");
+    const PropertyKey counterKey("counter");
+
+    printMeasurement("Get/Set, string key", measureAverageMs(iterations, [&](int i) {
+        object->Set("counter", object->Get<int>("counter") + i % 2);
+    }));
+    printMeasurement("Get/Set, PropertyKey", measureAverageMs(iterations, [&](int i) {
+        object->Set(counterKey, object->Get<int>(counterKey) + i % 2);
+    }));
+}
+
+// Same values in every shape ToVector handles: memcpy, converting copy, Array::Iterate and the per-element fallback.
+void benchmarkToVector(V8EngineManager& manager) {
+    auto engine = manager.getEngine();
+    const std::pair<const char*, const char*> shapes[] = {
+        {"Float64Array -> double", "new Float64Array(n).map((_, i) => i * 0.5)"},
+        {"Int32Array -> double", "new Int32Array(n).map((_, i) => i)"},
+        {"number array -> double", "Array.from({ length: n }, (_, i) => i * 0.5)"},
+        {"mixed array -> double (fallback)", "Array.from({ length: n }, (_, i) => i === 0 ? '0' : i * 0.5)"},
+    };
+
+    for (size_t elements = 1000; elements <= 10000000; elements *= 10) {
+        const int iterations = static_cast<int>(std::max<size_t>(1, 1000000 / elements));
+        for (const auto& [label, factory] : shapes) {
+            auto array = engine.get()->ExecuteJS("((n) => " + std::string(factory) + ")(" +
+                                                 std::to_string(elements) + ")");
+            printMeasurement(std::string(label) + ", " + std::to_string(elements), measureAverageMs(iterations, [&](int) {
+                array->ToVector<double>();
+            }));
+        }
+    }
+}
+
+class RecordSource : public V8NativeDataSource {
+public:
+    explicit RecordSource(int id) : id_(id) {}
+
+    V8NativeValue GetField(std::string_view name) const override {
+        if (name == "id") {
+            return static_cast<double>(id_);
+        }
+        if (name == "name") {
+            return "record " + std::to_string(id_);
+        }
+        if (name == "active") {
+            return id_ % 2 == 0;
+        }
+        return {};
+    }
+
+    std::vector<std::string> GetFieldNames() const override {
+        return {"id", "name", "active"};
+    }
+
+private:
+    int id_;
+};
+
+class RecordSetSource : public V8NativeDataSource {
+public:
+    explicit RecordSetSource(size_t count) : count_(count) {}
+
+    size_t GetLength() const override {
+        return count_;
+    }
+
+    V8NativeValue GetElement(size_t index) const override {
+        return std::make_shared<RecordSource>(static_cast<int>(index));
+    }
+
+private:
+    size_t count_;
+};
+
+// A script reading a few records out of a large set: the native object costs the same at every size.
+void benchmarkNativeObject(V8EngineManager& manager) {
+    auto engine = manager.getEngine();
+    engine.get()->ExecuteJS("function sumFirst(rows) { let sum = 0; for (let i = 0; i < 10; ++i) sum += rows[i].id; return sum; }");
+    for (size_t count : {size_t(1000), size_t(100000), size_t(1000000)}) {
+        const int iterations = count >= 1000000 ? 5 : 50;
+        const std::string suffix = ", " + std::to_string(count) + " records";
+
+        nlohmann::json records = nlohmann::json::array();
+        for (size_t i = 0; i < count; ++i) {
+            records.push_back({{"id", i}, {"name", "record " + std::to_string(i)}, {"active", i % 2 == 0}});
+        }
+        printMeasurement("CreateJSValueFromJson + read 10" + suffix, measureAverageMs(iterations, [&](int) {
+            std::vector<std::shared_ptr<JSValueWrapper>> args{engine.get()->CreateJSValueFromJson(records)};
+            engine.get()->CallJSFunction("sumFirst", args);
+        }));
+        printMeasurement("CreateNativeObject + read 10" + suffix, measureAverageMs(iterations, [&](int) {
+            std::vector<std::shared_ptr<JSValueWrapper>> args{
+                engine.get()->CreateNativeObject(std::make_shared<RecordSetSource>(count))};
+            engine.get()->CallJSFunction("sumFirst", args);
+        }));
+    }
+}
+
+// Deep nesting used to recurse once per level on the engine thread's stack.
+void benchmarkToJson(V8EngineManager& manager) {
+    auto engine = manager.getEngine();
+    const std::string text = makePayload(size_t(1) << 20).dump();
+    auto wide = engine.get()->CreateJSValueFromJsonText(text);
+    auto deep = engine.get()->ExecuteJS("(() => { let v = {}; for (let i = 0; i < 5000; ++i) v = { child: v }; return v; })()");
+    V8WalkOptions deepOptions;
+    deepOptions.max_depth = 10000;
+
+    printMeasurement("ToJson, 1 MB payload", measureAverageMs(20, [&](int) {
+        nlohmann::json json = wide->ToJson();
+    }));
+    printMeasurement("ToJson, 5000 levels deep", measureAverageMs(20, [&](int) {
+        nlohmann::json json = deep->ToJson(deepOptions);
+    }));
+}
+
+void benchmarkBinaryFormats(V8EngineManager& manager) {
+    auto engine = manager.getEngine();
+    auto value = engine.get()->CreateJSValueFromJsonText(makePayload(size_t(1) << 20).dump());
+    std::vector<uint8_t> msgpack = value->ToMsgPack();
+
+    // The writers must produce what nlohmann's readers decode back to the ToJson() document
+    const nlohmann::json expected = value->ToJson();
+    if (nlohmann::json::from_msgpack(msgpack) != expected) {
+        std::cerr << "ToMsgPack does not round-trip through nlohmann::json::from_msgpack" << std::endl;
+    }
+    if (nlohmann::json::from_cbor(value->ToCbor()) != expected) {
+        std::cerr << "ToCbor does not round-trip through nlohmann::json::from_cbor" << std::endl;
+    }
+
+    printMeasurement("ToJson + to_msgpack, 1 MB payload", measureAverageMs(20, [&](int) {
+        std::vector<uint8_t> bytes = nlohmann::json::to_msgpack(value->ToJson());
+    }));
+    printMeasurement("ToMsgPack, 1 MB payload", measureAverageMs(20, [&](int) {
+        std::vector<uint8_t> bytes = value->ToMsgPack();
+    }));
+    printMeasurement("ToCbor, 1 MB payload", measureAverageMs(20, [&](int) {
+        std::vector<uint8_t> bytes = value->ToCbor();
+    }));
+    printMeasurement("from_msgpack + CreateJSValueFromJson", measureAverageMs(20, [&](int) {
+        engine.get()->CreateJSValueFromJson(nlohmann::json::from_msgpack(msgpack));
+    }));
+    printMeasurement("CreateJSValueFromMsgPack", measureAverageMs(20, [&](int) {
+        engine.get()->CreateJSValueFromMsgPack(msgpack);
+    }));
+}
+
+// Output to a discarding sink, so only the serialization itself is measured.
+void benchmarkJsonStreaming(V8EngineManager& manager) {
+    auto engine = manager.getEngine();
+    auto value = engine.get()->CreateJSValueFromJsonText(makePayload(size_t(10) << 20).dump());
+    size_t written = 0;
+
+    printMeasurement("ToJson().dump(), 10 MB payload", measureAverageMs(5, [&](int) {
+        written += value->ToJson().dump().size();
+    }));
+    printMeasurement("ToJsonString(), 10 MB payload", measureAverageMs(5, [&](int) {
+        written += value->ToJsonString().size();
+    }));
+    printMeasurement("ToJsonChunks(64 KB), 10 MB payload", measureAverageMs(5, [&](int) {
+        value->ToJsonChunks([&](std::string_view chunk) {
+            written += chunk.size();
+        });
+    }));
+}
+
+void benchmarkExternalStrings(V8EngineManager& manager) {
+    auto engine = manager.getEngine();
+    auto document = std::make_shared<const std::string>(size_t(10) << 20, 'x');
+    auto holder = engine.get()->CreateJSValue("({})");
+
+    printMeasurement("Set(std::string), 10 MB", measureAverageMs(20, [&](int) {
+        holder->Set("doc", *document);
+    }));
+    printMeasurement("Set(shared_ptr<const std::string>), 10 MB", measureAverageMs(20, [&](int) {
+        holder->Set("doc", document);
+    }));
+
+    auto text = engine.get()->ExecuteJS("'y'.repeat(10 * 1024 * 1024)");
+    printMeasurement("Get<std::string>(), 10 MB", measureAverageMs(20, [&](int) {
+        std::string copy = text->Get<std::string>();
+    }));
+    printMeasurement("GetStringView(), 10 MB", measureAverageMs(20, [&](int) {
+        V8StringView view = text->GetStringView();
+    }));
+}
+
+// One task hop per record against one hop per batch; `score` comes from the bootstrap.
+void benchmarkBatchCalls(V8EngineManager& manager) {
+    const int records = 100000;
+    std::vector<nlohmann::json> inputs;
+    inputs.reserve(records);
+    for (int i = 0; i < records; ++i) {
+        inputs.push_back({{"a", i}, {"b", i * 0.5}});
+    }
+
+    {
+        auto engine = manager.getEngine();
+        printMeasurement("CallJSFunction per record, 100K records", measureAverageMs(1, [&](int) {
+            for (const auto& input : inputs) {
+                std::vector<std::shared_ptr<JSValueWrapper>> args{engine.get()->CreateJSValueFromJson(input)};
+                engine.get()->CallJSFunction("score", args)->Get<double>();
+            }
+        }));
+        printMeasurement("CallJSFunctionBatch, 1 engine, 100K records", measureAverageMs(5, [&](int) {
+            engine.get()->CallJSFunctionBatch<double>("score", inputs);
+        }));
+    }
+    printMeasurement("CallJSFunctionBatch, 4 engines, 100K records", measureAverageMs(5, [&](int) {
+        manager.CallJSFunctionBatch<double>("score", inputs, 4);
+    }));
+}
+
+void benchmarkMapReduce(V8EngineManager& manager) {
+    std::vector<nlohmann::json> partitions;
+    for (int p = 0; p < 64; ++p) {
+        nlohmann::json partition = nlohmann::json::array();
+        for (int i = 0; i < 10000; ++i) {
+            partition.push_back({{"a", p * 10000 + i}, {"b", i * 0.5}});
+        }
+        partitions.push_back(std::move(partition));
+    }
+    const std::string mapper = "(records) => records.reduce((sum, record) => sum + score(record), 0)";
+    const std::string reducer = "(total, partial) => total + partial";
+
+    {
+        auto engine = manager.getEngine();
+        printMeasurement("CallJSFunctionBatch + C++ sum, 1 engine, 64 x 10K records", measureAverageMs(3, [&](int) {
+            double total = 0;
+            for (const auto& partition : partitions) {
+                for (double score : engine.get()->CallJSFunctionBatch<double>("score", partition.get_ref<const nlohmann::json::array_t&>())) {
+                    total += score;
+                }
+            }
+        }));
+    }
+    printMeasurement("MapReduce, whole pool, 64 x 10K records", measureAverageMs(3, [&](int) {
+        auto result = manager.MapReduce<double>(mapper, reducer, partitions);
+        if (!result.completed) {
+            std::cerr << "MapReduce failed: " << result.error << std::endl;
+        }
+    }));
+}
+
+void benchmarkSessions(V8EngineManager& manager) {
+    const std::string buildState = "globalThis.prices = new Map(Array.from({length: 50000}, (_, i) => ['sku' + i, i * 1.5]));";
+    const std::string request = "prices.get('sku4242') * 3";
+
+    printMeasurement("getEngine + rebuild state per request", measureAverageMs(20, [&](int) {
+        auto engine = manager.getEngine();
+        engine.get()->ExecuteJS(buildState);
+        engine.get()->ExecuteJS(request)->Get<double>();
+    }));
+    printMeasurement("getSession, state kept in the session", measureAverageMs(20, [&](int) {
+        auto session = manager.getSession("user-1");
+        if (session.get()->ExecuteJS("typeof prices")->Get<std::string>() != "object") {
+            session.get()->ExecuteJS(buildState);
+        }
+        session.get()->ExecuteJS(request)->Get<double>();
+    }));
+    const V8SessionMetrics metrics = manager.GetSessionMetrics();
+    std::cout << "Session hits: " << metrics.hits << ", misses: " << metrics.misses << std::endl;
+}
+
+void benchmarkMemoization(V8EngineManager& manager) {
+    std::vector<nlohmann::json> records;
+    for (int i = 0; i < 10000; ++i) {
+        records.push_back({{"a", i % 100}, {"b", 0.5}});
+    }
+    auto memoizedScore = manager.Memoize<double, nlohmann::json>("score");
+
+    printMeasurement("CallJSFunctionTyped, 10K records, 100 distinct", measureAverageMs(5, [&](int) {
+        auto engine = manager.getEngine();
+        for (const auto& record : records) {
+            engine.get()->CallJSFunctionTyped<double>("score", record);
+        }
+    }));
+    printMeasurement("Memoized score, 10K records, 100 distinct", measureAverageMs(5, [&](int) {
+        for (const auto& record : records) {
+            memoizedScore->Call(record);
+        }
+    }));
+    const V8MemoCacheStats stats = manager.GetMemoCache().GetStats();
+    std::cout << "Memo cache hits: " << stats.hits << ", misses: " << stats.misses << std::endl;
+}
+
+int main() {
+    V8EngineBootstrap bootstrap;
+    bootstrap.scripts.push_back("function score(record) { return record.a * 2 + record.b; }");
+    V8EngineManager manager(4, bootstrap);
+
+    std::cout << "Micro Benchmarks:" << std::endl;
+    benchmarkExecuteWithCallbacks(manager);
+    benchmarkFastApiCallback(manager);
+    benchmarkJsonConstruction(manager);
+    benchmarkPropertyAccess(manager);
+    benchmarkToVector(manager);
+    benchmarkNativeObject(manager);
+    benchmarkToJson(manager);
+    benchmarkBinaryFormats(manager);
+    benchmarkJsonStreaming(manager);
+    benchmarkExternalStrings(manager);
+    benchmarkBatchCalls(manager);
+    benchmarkMapReduce(manager);
+    benchmarkSessions(manager);
+    benchmarkMemoization(manager);
+
+    return 0;
+}
@@ -0,0 +1,677 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// MessagePack and CBOR straight between V8 values and bytes, with no intermediate document. The writers are
+// V8ValueWalker sinks; the readers build V8 values as they decode. Integers are written in their shortest
+// encoding and doubles as float64. Binary strings read back as Uint8Array, like binary values of
+// CreateJSValueFromJson.
+
+class V8BinaryWriter
+{
+public:
+    explicit V8BinaryWriter(std::vector<uint8_t> &out)
+        : out_(out)
+    {
+    }
+
+protected:
+    std::vector<uint8_t> &out_;
+
+    void Byte(uint8_t value)
+    {
+        out_.push_back(value);
+    }
+
+    // Both formats are big-endian.
+    void BigEndian(uint64_t value, int bytes)
+    {
+        for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+        {
+            out_.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    void Double(double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        BigEndian(bits, 8);
+    }
+
+    void Bytes(std::string_view value)
+    {
+        out_.insert(out_.end(), value.begin(), value.end());
+    }
+};
+
+class V8MsgPackWriter : public V8BinaryWriter
+{
+public:
+    using V8BinaryWriter::V8BinaryWriter;
+
+    void Null() { Byte(0xc0); }
+    void Boolean(bool value) { Byte(value ? 0xc3 : 0xc2); }
+
+    void Integer(int64_t value)
+    {
+        if (value >= 0)
+        {
+            Unsigned(static_cast<uint64_t>(value));
+        } else if (value >= -32)
+        {
+            Byte(static_cast<uint8_t>(value));
+        } else if (value >= INT8_MIN)
+        {
+            Byte(0xd0);
+            BigEndian(static_cast<uint64_t>(value), 1);
+        } else if (value >= INT16_MIN)
+        {
+            Byte(0xd1);
+            BigEndian(static_cast<uint64_t>(value), 2);
+        } else if (value >= INT32_MIN)
+        {
+            Byte(0xd2);
+            BigEndian(static_cast<uint64_t>(value), 4);
+        } else
+        {
+            Byte(0xd3);
+            BigEndian(static_cast<uint64_t>(value), 8);
+        }
+    }
+
+    void Unsigned(uint64_t value)
+    {
+        if (value < 0x80)
+        {
+            Byte(static_cast<uint8_t>(value));
+        } else if (value <= UINT8_MAX)
+        {
+            Byte(0xcc);
+            BigEndian(value, 1);
+        } else if (value <= UINT16_MAX)
+        {
+            Byte(0xcd);
+            BigEndian(value, 2);
+        } else if (value <= UINT32_MAX)
+        {
+            Byte(0xce);
+            BigEndian(value, 4);
+        } else
+        {
+            Byte(0xcf);
+            BigEndian(value, 8);
+        }
+    }
+
+    void Number(double value)
+    {
+        Byte(0xcb);
+        Double(value);
+    }
+
+    void String(std::string_view value)
+    {
+        Head(value.size(), 0xa0, 32, 0xd9, 0xda, 0xdb);
+        Bytes(value);
+    }
+
+    void BeginArray(size_t count) { Head(count, 0x90, 16, 0, 0xdc, 0xdd); }
+    void EndArray() {}
+    void BeginObject(size_t count) { Head(count, 0x80, 16, 0, 0xde, 0xdf); }
+    void Key(std::string_view key) { String(key); }
+    void EndObject() {}
+
+private:
+    // fix_limit is exclusive; a zero marker8 means the type has no 8-bit length form.
+    void Head(size_t length, uint8_t fix, size_t fix_limit, uint8_t marker8, uint8_t marker16, uint8_t marker32)
+    {
+        if (length < fix_limit)
+        {
+            Byte(static_cast<uint8_t>(fix | length));
+        } else if (marker8 != 0 && length <= UINT8_MAX)
+        {
+            Byte(marker8);
+            BigEndian(length, 1);
+        } else if (length <= UINT16_MAX)
+        {
+            Byte(marker16);
+            BigEndian(length, 2);
+        } else if (length <= UINT32_MAX)
+        {
+            Byte(marker32);
+            BigEndian(length, 4);
+        } else
+        {
+            throw std::runtime_error("Value is too large for MessagePack");
+        }
+    }
+};
+
+class V8CborWriter : public V8BinaryWriter
+{
+public:
+    using V8BinaryWriter::V8BinaryWriter;
+
+    void Null() { Byte(0xf6); }
+    void Boolean(bool value) { Byte(value ? 0xf5 : 0xf4); }
+
+    void Integer(int64_t value)
+    {
+        if (value >= 0)
+        {
+            Head(0, static_cast<uint64_t>(value));
+        } else
+        {
+            // Major type 1 encodes -1 - n
+            Head(1, ~static_cast<uint64_t>(value));
+        }
+    }
+
+    void Unsigned(uint64_t value) { Head(0, value); }
+
+    void Number(double value)
+    {
+        Byte(0xfb);
+        Double(value);
+    }
+
+    void String(std::string_view value)
+    {
+        Head(3, value.size());
+        Bytes(value);
+    }
+
+    void BeginArray(size_t count) { Head(4, count); }
+    void EndArray() {}
+    void BeginObject(size_t count) { Head(5, count); }
+    void Key(std::string_view key) { String(key); }
+    void EndObject() {}
+
+private:
+    void Head(uint8_t major, uint64_t value)
+    {
+        const auto type = static_cast<uint8_t>(major << 5);
+        if (value < 24)
+        {
+            Byte(static_cast<uint8_t>(type | value));
+        } else if (value <= UINT8_MAX)
+        {
+            Byte(type | 24);
+            BigEndian(value, 1);
+        } else if (value <= UINT16_MAX)
+        {
+            Byte(type | 25);
+            BigEndian(value, 2);
+        } else if (value <= UINT32_MAX)
+        {
+            Byte(type | 26);
+            BigEndian(value, 4);
+        } else
+        {
+            Byte(type | 27);
+            BigEndian(value, 8);
+        }
+    }
+};
+
+// Shared decoding state. Readers throw std::runtime_error on truncated or malformed input, on nesting deeper
+// than kMaxDepth and on extension types they can't represent.
+class V8BinaryReader
+{
+public:
+    // Same limit as V8Converter<nlohmann::json>::ToV8.
+    static constexpr int kMaxDepth = 1000;
+
+protected:
+    V8BinaryReader(v8::Isolate *isolate, v8::Local<v8::Context> context, const uint8_t *data, size_t size)
+        : isolate_(isolate), context_(context), data_(data), size_(size)
+    {
+    }
+
+    v8::Isolate *isolate_;
+    v8::Local<v8::Context> context_;
+    const uint8_t *data_;
+    size_t size_;
+    size_t position_ = 0;
+
+    const uint8_t *Take(uint64_t count)
+    {
+        if (count > size_ - position_)
+        {
+            throw std::runtime_error("Unexpected end of input");
+        }
+        const uint8_t *start = data_ + position_;
+        position_ += count;
+        return start;
+    }
+
+    uint8_t Byte()
+    {
+        return *Take(1);
+    }
+
+    uint8_t Peek() const
+    {
+        if (position_ >= size_)
+        {
+            throw std::runtime_error("Unexpected end of input");
+        }
+        return data_[position_];
+    }
+
+    uint64_t BigEndian(int bytes)
+    {
+        const uint8_t *start = Take(bytes);
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i)
+        {
+            value = value << 8 | start[i];
+        }
+        return value;
+    }
+
+    double Float32()
+    {
+        const auto bits = static_cast<uint32_t>(BigEndian(4));
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    double Float64()
+    {
+        const uint64_t bits = BigEndian(8);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    static void CheckDepth(int depth)
+    {
+        if (depth >= kMaxDepth)
+        {
+            throw std::runtime_error("Input exceeds the maximum nesting depth");
+        }
+    }
+
+    void CheckFullyConsumed() const
+    {
+        if (position_ != size_)
+        {
+            throw std::runtime_error("Trailing bytes after the encoded value");
+        }
+    }
+
+    v8::Local<v8::Value> NewInteger(int64_t value) const
+    {
+        if (value >= INT32_MIN && value <= INT32_MAX)
+        {
+            return v8::Integer::New(isolate_, static_cast<int32_t>(value));
+        }
+        return v8::Number::New(isolate_, static_cast<double>(value));
+    }
+
+    v8::Local<v8::Value> NewUnsigned(uint64_t value) const
+    {
+        if (value <= UINT32_MAX)
+        {
+            return v8::Integer::NewFromUnsigned(isolate_, static_cast<uint32_t>(value));
+        }
+        return v8::Number::New(isolate_, static_cast<double>(value));
+    }
+
+    v8::Local<v8::Value> NewString(const uint8_t *bytes, uint64_t length) const
+    {
+        if (length > static_cast<uint64_t>(v8::String::kMaxLength))
+        {
+            throw std::runtime_error("String is too long for V8");
+        }
+        v8::Local<v8::String> string;
+        if (!v8::String::NewFromUtf8(isolate_, reinterpret_cast<const char *>(bytes), v8::NewStringType::kNormal,
+                                     static_cast<int>(length)).ToLocal(&string))
+        {
+            throw std::runtime_error("Failed to create string");
+        }
+        return string;
+    }
+
+    v8::Local<v8::Value> NewBinary(const uint8_t *bytes, uint64_t length) const
+    {
+        const v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate_, length);
+        if (length != 0)
+        {
+            std::memcpy(buffer->Data(), bytes, length);
+        }
+        return v8::Uint8Array::New(buffer, 0, length);
+    }
+
+    // Map keys that aren't strings are stringified, as JS property keys are.
+    void SetEntry(v8::Local<v8::Object> object, v8::Local<v8::Value> key, v8::Local<v8::Value> value) const
+    {
+        v8::Local<v8::String> name;
+        if (key->IsString())
+        {
+            name = key.As<v8::String>();
+        } else if (!key->ToString(context_).ToLocal(&name))
+        {
+            throw std::runtime_error("Failed to convert map key to string");
+        }
+        // Plain data properties: no setters on the prototype chain are consulted
+        if (object->CreateDataProperty(context_, name, value).IsNothing())
+        {
+            throw std::runtime_error("Failed to set decoded property");
+        }
+    }
+};
+
+class V8MsgPackReader : public V8BinaryReader
+{
+public:
+    static v8::Local<v8::Value> Read(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                     const uint8_t *data, size_t size)
+    {
+        V8MsgPackReader reader(isolate, context, data, size);
+        const v8::Local<v8::Value> value = reader.ReadValue(0);
+        reader.CheckFullyConsumed();
+        return value;
+    }
+
+private:
+    using V8BinaryReader::V8BinaryReader;
+
+    v8::Local<v8::Value> ReadValue(int depth)
+    {
+        const uint8_t marker = Byte();
+        if (marker <= 0x7f)
+        {
+            return v8::Integer::New(isolate_, marker);
+        }
+        if (marker >= 0xe0)
+        {
+            return v8::Integer::New(isolate_, static_cast<int8_t>(marker));
+        }
+        if ((marker & 0xf0) == 0x80)
+        {
+            return ReadMap(marker & 0x0f, depth);
+        }
+        if ((marker & 0xf0) == 0x90)
+        {
+            return ReadArray(marker & 0x0f, depth);
+        }
+        if ((marker & 0xe0) == 0xa0)
+        {
+            const uint64_t length = marker & 0x1f;
+            return NewString(Take(length), length);
+        }
+        switch (marker)
+        {
+            case 0xc0:
+                return v8::Null(isolate_);
+            case 0xc2:
+                return v8::False(isolate_);
+            case 0xc3:
+                return v8::True(isolate_);
+            case 0xc4:
+            case 0xc5:
+            case 0xc6:
+            {
+                const uint64_t length = BigEndian(1 << (marker - 0xc4));
+                return NewBinary(Take(length), length);
+            }
+            case 0xca:
+                return v8::Number::New(isolate_, Float32());
+            case 0xcb:
+                return v8::Number::New(isolate_, Float64());
+            case 0xcc:
+            case 0xcd:
+            case 0xce:
+            case 0xcf:
+                return NewUnsigned(BigEndian(1 << (marker - 0xcc)));
+            case 0xd0:
+                return NewInteger(static_cast<int8_t>(BigEndian(1)));
+            case 0xd1:
+                return NewInteger(static_cast<int16_t>(BigEndian(2)));
+            case 0xd2:
+                return NewInteger(static_cast<int32_t>(BigEndian(4)));
+            case 0xd3:
+                return NewInteger(static_cast<int64_t>(BigEndian(8)));
+            case 0xd9:
+            case 0xda:
+            case 0xdb:
+            {
+                const uint64_t length = BigEndian(1 << (marker - 0xd9));
+                return NewString(Take(length), length);
+            }
+            case 0xdc:
+                return ReadArray(BigEndian(2), depth);
+            case 0xdd:
+                return ReadArray(BigEndian(4), depth);
+            case 0xde:
+                return ReadMap(BigEndian(2), depth);
+            case 0xdf:
+                return ReadMap(BigEndian(4), depth);
+            default:
+                throw std::runtime_error("Unsupported MessagePack type");
+        }
+    }
+
+    v8::Local<v8::Value> ReadArray(uint64_t count, int depth)
+    {
+        CheckDepth(depth);
+        // Every element takes at least one byte, which bounds the reservation by the input size
+        if (count > size_ - position_)
+        {
+            throw std::runtime_error("Unexpected end of input");
+        }
+        std::vector<v8::Local<v8::Value> > elements;
+        elements.reserve(count);
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            elements.push_back(ReadValue(depth + 1));
+        }
+        return v8::Array::New(isolate_, elements.data(), elements.size());
+    }
+
+    v8::Local<v8::Value> ReadMap(uint64_t count, int depth)
+    {
+        CheckDepth(depth);
+        const v8::Local<v8::Object> object = v8::Object::New(isolate_);
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            const v8::Local<v8::Value> key = ReadValue(depth + 1);
+            SetEntry(object, key, ReadValue(depth + 1));
+        }
+        return object;
+    }
+};
+
+class V8CborReader : public V8BinaryReader
+{
+public:
+    static v8::Local<v8::Value> Read(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                     const uint8_t *data, size_t size)
+    {
+        V8CborReader reader(isolate, context, data, size);
+        const v8::Local<v8::Value> value = reader.ReadValue(0);
+        reader.CheckFullyConsumed();
+        return value;
+    }
+
+private:
+    using V8BinaryReader::V8BinaryReader;
+
+    static constexpr uint8_t kIndefinite = 31;
+    static constexpr uint8_t kBreak = 0xff;
+
+    uint64_t Argument(uint8_t info)
+    {
+        if (info < 24)
+        {
+            return info;
+        }
+        if (info <= 27)
+        {
+            return BigEndian(1 << (info - 24));
+        }
+        throw std::runtime_error("Malformed CBOR length");
+    }
+
+    v8::Local<v8::Value> ReadValue(int depth)
+    {
+        uint8_t initial = Byte();
+        // Tags carry no meaning here; a run of them is skipped in a loop, so tag-only input can't recurse
+        while (initial >> 5 == 6)
+        {
+            Argument(initial & 0x1f);
+            initial = Byte();
+        }
+        const uint8_t major = initial >> 5;
+        const uint8_t info = initial & 0x1f;
+        switch (major)
+        {
+            case 0:
+                return NewUnsigned(Argument(info));
+            case 1:
+            {
+                const uint64_t argument = Argument(info);
+                if (argument <= static_cast<uint64_t>(INT64_MAX))
+                {
+                    return NewInteger(-1 - static_cast<int64_t>(argument));
+                }
+                return v8::Number::New(isolate_, -1.0 - static_cast<double>(argument));
+            }
+            case 2:
+            case 3:
+            {
+                std::string chunks;
+                const uint8_t *bytes;
+                uint64_t length;
+                if (info == kIndefinite)
+                {
+                    // Concatenation of definite-length chunks of the same major type
+                    while (Peek() != kBreak)
+                    {
+                        const uint8_t chunk = Byte();
+                        if (chunk >> 5 != major || (chunk & 0x1f) == kIndefinite)
+                        {
+                            throw std::runtime_error("Malformed CBOR string chunk");
+                        }
+                        const uint64_t chunk_length = Argument(chunk & 0x1f);
+                        chunks.append(reinterpret_cast<const char *>(Take(chunk_length)), chunk_length);
+                    }
+                    Byte();
+                    bytes = reinterpret_cast<const uint8_t *>(chunks.data());
+                    length = chunks.size();
+                } else
+                {
+                    length = Argument(info);
+                    bytes = Take(length);
+                }
+                return major == 2 ? NewBinary(bytes, length) : NewString(bytes, length);
+            }
+            case 4:
+                return ReadArray(info, depth);
+            case 5:
+                return ReadMap(info, depth);
+            default:
+                return ReadSimple(info);
+        }
+    }
+
+    v8::Local<v8::Value> ReadSimple(uint8_t info)
+    {
+        switch (info)
+        {
+            case 20:
+                return v8::False(isolate_);
+            case 21:
+                return v8::True(isolate_);
+            case 22:
+                return v8::Null(isolate_);
+            case 23:
+                return v8::Undefined(isolate_);
+            case 25:
+                return v8::Number::New(isolate_, HalfFloat(static_cast<uint16_t>(BigEndian(2))));
+            case 26:
+                return v8::Number::New(isolate_, Float32());
+            case 27:
+                return v8::Number::New(isolate_, Float64());
+            default:
+                throw std::runtime_error("Unsupported CBOR simple value");
+        }
+    }
+
+    static double HalfFloat(uint16_t half)
+    {
+        const int exponent = half >> 10 & 0x1f;
+        const int mantissa = half & 0x3ff;
+        double value;
+        if (exponent == 0)
+        {
+            value = std::ldexp(mantissa, -24);
+        } else if (exponent != 31)
+        {
+            value = std::ldexp(mantissa + 1024, exponent - 25);
+        } else
+        {
+            value = mantissa == 0 ? INFINITY : NAN;
+        }
+        return half & 0x8000 ? -value : value;
+    }
+
+    v8::Local<v8::Value> ReadArray(uint8_t info, int depth)
+    {
+        CheckDepth(depth);
+        std::vector<v8::Local<v8::Value> > elements;
+        if (info == kIndefinite)
+        {
+            while (Peek() != kBreak)
+            {
+                elements.push_back(ReadValue(depth + 1));
+            }
+            Byte();
+        } else
+        {
+            const uint64_t count = Argument(info);
+            // Every element takes at least one byte, which bounds the reservation by the input size
+            if (count > size_ - position_)
+            {
+                throw std::runtime_error("Unexpected end of input");
+            }
+            elements.reserve(count);
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                elements.push_back(ReadValue(depth + 1));
+            }
+        }
+        return v8::Array::New(isolate_, elements.data(), elements.size());
+    }
+
+    v8::Local<v8::Value> ReadMap(uint8_t info, int depth)
+    {
+        CheckDepth(depth);
+        const v8::Local<v8::Object> object = v8::Object::New(isolate_);
+        const bool indefinite = info == kIndefinite;
+        const uint64_t count = indefinite ? 0 : Argument(info);
+        for (uint64_t i = 0; indefinite ? Peek() != kBreak : i < count; ++i)
+        {
+            const v8::Local<v8::Value> key = ReadValue(depth + 1);
+            SetEntry(object, key, ReadValue(depth + 1));
+        }
+        if (indefinite)
+        {
+            Byte();
+        }
+        return object;
+    }
+};
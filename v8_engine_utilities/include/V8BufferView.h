@@ -0,0 +1,58 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+
+// Native view of the bytes behind an ArrayBuffer, SharedArrayBuffer or typed array. The view holds the backing
+// store, so the span stays valid even after the JS value is collected. Reads and writes race with JS running
+// on the engine unless the caller coordinates, e.g. through Atomics on a SharedArrayBuffer.
+struct V8BufferView
+{
+    std::shared_ptr<v8::BackingStore> backing_store;
+    std::span<std::byte> bytes;
+
+    template<typename T>
+    [[nodiscard]] std::span<T> As() const
+    {
+        return {reinterpret_cast<T *>(bytes.data()), bytes.size() / sizeof(T)};
+    }
+};
+
+// Memory from the engines' ArrayBuffer allocator, which V8 adopts as a backing store without copying even with
+// V8_ENABLE_SANDBOX. Only V8EngineContext::AllocateBuffer creates one, so memory from anywhere else can't be
+// passed where sandbox memory is required.
+class V8NativeBuffer
+{
+public:
+    [[nodiscard]] std::byte *data() const
+    {
+        return static_cast<std::byte *>(memory_.get());
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return byte_length_;
+    }
+
+    template<typename T>
+    [[nodiscard]] std::span<T> As() const
+    {
+        return {reinterpret_cast<T *>(memory_.get()), byte_length_ / sizeof(T)};
+    }
+
+private:
+    friend class V8EngineContext;
+
+    V8NativeBuffer(std::shared_ptr<void> memory, size_t byte_length)
+        : memory_(std::move(memory)), byte_length_(byte_length)
+    {
+    }
+
+    std::shared_ptr<void> memory_;
+    size_t byte_length_ = 0;
+};
@@ -3,8 +3,17 @@
 //
 #pragma once
 #include <v8.h>
+#include <v8-fast-api-calls.h>
 #include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "V8TypeConversion.h"
 
+// Owned by a single engine and only touched from its execution thread.
 class V8CallbackManager
 {
 public:
@@ -16,46 +25,199 @@ public:
     void RegisterCallback(const std::string &name,
                           JavascriptCallback callback)
     {
-        callbacks_[name] = std::move(callback);
+        AddEntry(name, InvokeCallback, std::make_shared<JavascriptCallback>(std::move(callback)));
     }
 
-    void ExposeCallbacks(v8::Isolate *isolate, const v8::Local<v8::Context> context) const
+    // Registers a callback with a V8 Fast API twin that TurboFan-optimized code calls directly, skipping
+    // FunctionCallbackInfo. The slow callback still serves the interpreter and any call the fast path rejects,
+    // so both must behave identically. The fast function must not allocate on the JS heap or call back into JS.
+    void RegisterCallback(const std::string &name,
+                          JavascriptCallback callback,
+                          const v8::CFunction &fast_function)
     {
-        const v8::Local<v8::Object> global = context->Global();
+        AddEntry(name, InvokeCallback, std::make_shared<JavascriptCallback>(std::move(callback)), fast_function);
+    }
 
-        for (const auto &[name, callback]: callbacks_)
-        {
-            v8::Local<v8::String> func_name = v8::String::NewFromUtf8(isolate, name.c_str()).ToLocalChecked();
-            v8::Local<v8::Function> func = v8::Function::New(context,
-                                                             [](const v8::FunctionCallbackInfo<v8::Value> &args)
-                                                             {
-                                                                 v8::Isolate *isolate_ = args.GetIsolate();
-                                                                 v8::HandleScope handle_scope(isolate_);
-                                                                 const v8::Local<v8::External> data = v8::Local<
-                                                                     v8::External>::Cast(args.Data());
-                                                                 const auto *callback_ptr = static_cast<std::function<
-                                                                         void(
-                                                                             const v8::FunctionCallbackInfo<v8::Value> &
-                                                                         )>
-                                                                     *>(
-                                                                     data->Value());
-                                                                 (*callback_ptr)(args);
-                                                             },
-                                                             v8::External::New(
-                                                                 isolate, const_cast<std::function<void(
-                                                                     const v8::FunctionCallbackInfo<v8::Value> &)> *>(&
-                                                                     callback))
-            ).ToLocalChecked();
+    // Binds a free function with its argument and return marshalling generated at compile time.
+    template<typename R, typename... Args>
+    void RegisterFunction(const std::string &name, R (*function)(Args...))
+    {
+        using Binding = FunctionBinding<R, Args...>;
+        AddEntry(name, InvokeBinding<Binding>, std::make_shared<Binding>(Binding{function}));
+    }
+
+    // Binds a member function; the instance must outlive the contexts the function is installed in.
+    template<typename C, typename R, typename... Args>
+    void RegisterFunction(const std::string &name, R (C::*method)(Args...), C *instance)
+    {
+        using Binding = MethodBinding<C, R (C::*)(Args...), R, Args...>;
+        AddEntry(name, InvokeBinding<Binding>, std::make_shared<Binding>(Binding{instance, method}));
+    }
 
-            global->Set(context, func_name, func).Check();
+    template<typename C, typename R, typename... Args>
+    void RegisterFunction(const std::string &name, R (C::*method)(Args...) const, const C *instance)
+    {
+        using Binding = MethodBinding<const C, R (C::*)(Args...) const, R, Args...>;
+        AddEntry(name, InvokeBinding<Binding>, std::make_shared<Binding>(Binding{instance, method}));
+    }
+
+    // Installs one callback on an already running context, right after it was registered.
+    void InstallCallback(v8::Isolate *isolate, const v8::Local<v8::Context> context, const std::string &name)
+    {
+        const auto it = callbacks_.find(name);
+        if (it == callbacks_.end())
+        {
+            return;
+        }
+        v8::Local<v8::Function> func;
+        if (!GetFunctionTemplate(isolate, it->second)->GetFunction(context).ToLocal(&func))
+        {
+            return;
         }
+        v8::Local<v8::String> func_name = v8::String::NewFromUtf8(isolate, name.c_str()).ToLocalChecked();
+        context->Global()->Set(context, func_name, func).Check();
     }
 
+    // Forgets the registrations. Their targets stay alive until DetachTargets, since functions already installed
+    // in the context may still call them.
     void ClearCallbacks()
     {
+        for (auto &[name, entry]: callbacks_)
+        {
+            retired_.push_back(std::move(entry.target));
+        }
         callbacks_.clear();
     }
 
+    // Hands over every target the current context may reference, registered or retired, and starts empty for the
+    // next context. The caller keeps them alive for as long as that context lives.
+    std::vector<std::shared_ptr<void> > DetachTargets()
+    {
+        ClearCallbacks();
+        return std::move(retired_);
+    }
+
 private:
-    std::unordered_map<std::string, std::function<void(const v8::FunctionCallbackInfo<v8::Value> &)> > callbacks_;
+    struct CallbackEntry
+    {
+        v8::FunctionCallback invoker;
+        v8::CFunction fast_function;
+        // Target reached through the template's External: a JavascriptCallback or a typed binding.
+        std::shared_ptr<void> target;
+        v8::Global<v8::FunctionTemplate> function_template;
+    };
+
+    template<typename R, typename... Args>
+    struct FunctionBinding
+    {
+        R (*function)(Args...);
+
+        R operator()(Args... args) const
+        {
+            return function(std::forward<Args>(args)...);
+        }
+    };
+
+    template<typename C, typename Method, typename R, typename... Args>
+    struct MethodBinding
+    {
+        C *instance;
+        Method method;
+
+        R operator()(Args... args) const
+        {
+            return (instance->*method)(std::forward<Args>(args)...);
+        }
+    };
+
+    template<typename Binding>
+    struct BindingTraits;
+
+    template<typename R, typename... Args>
+    struct BindingTraits<FunctionBinding<R, Args...> >
+    {
+        using Result = R;
+        using Arguments = std::tuple<Args...>;
+    };
+
+    template<typename C, typename Method, typename R, typename... Args>
+    struct BindingTraits<MethodBinding<C, Method, R, Args...> >
+    {
+        using Result = R;
+        using Arguments = std::tuple<Args...>;
+    };
+
+    std::unordered_map<std::string, CallbackEntry> callbacks_;
+    // Targets of replaced callbacks; functions created from their templates may still be referenced by the context.
+    std::vector<std::shared_ptr<void> > retired_;
+
+    void AddEntry(const std::string &name, v8::FunctionCallback invoker, std::shared_ptr<void> target,
+                  const v8::CFunction &fast_function = v8::CFunction())
+    {
+        CallbackEntry &entry = callbacks_[name];
+        if (entry.target)
+        {
+            retired_.push_back(std::move(entry.target));
+            entry.function_template.Reset();
+        }
+        entry.invoker = invoker;
+        entry.fast_function = fast_function;
+        entry.target = std::move(target);
+    }
+
+    static void InvokeCallback(const v8::FunctionCallbackInfo<v8::Value> &args)
+    {
+        v8::HandleScope handle_scope(args.GetIsolate());
+        const auto *callback_ptr = static_cast<JavascriptCallback *>(args.Data().As<v8::External>()->Value());
+        (*callback_ptr)(args);
+    }
+
+    template<typename Binding>
+    static void InvokeBinding(const v8::FunctionCallbackInfo<v8::Value> &args)
+    {
+        v8::HandleScope handle_scope(args.GetIsolate());
+        const auto *binding = static_cast<Binding *>(args.Data().As<v8::External>()->Value());
+        using Arguments = typename BindingTraits<Binding>::Arguments;
+        Dispatch<typename BindingTraits<Binding>::Result, Arguments>(
+            args, *binding, std::make_index_sequence<std::tuple_size_v<Arguments> >{});
+    }
+
+    template<typename R, typename Arguments, typename Binding, size_t... I>
+    static void Dispatch(const v8::FunctionCallbackInfo<v8::Value> &args, const Binding &binding,
+                         std::index_sequence<I...>)
+    {
+        v8::Isolate *isolate = args.GetIsolate();
+        const v8::Local<v8::Context> context = isolate->GetCurrentContext();
+        // Missing arguments read as undefined and convert to the type's default, matching JS calling conventions.
+        if constexpr (std::is_void_v<R>)
+        {
+            binding(V8Converter<std::decay_t<std::tuple_element_t<I, Arguments> > >::FromV8(
+                isolate, context, args[static_cast<int>(I)])...);
+        } else
+        {
+            args.GetReturnValue().Set(V8Converter<std::decay_t<R> >::ToV8(
+                isolate, context,
+                binding(V8Converter<std::decay_t<std::tuple_element_t<I, Arguments> > >::FromV8(
+                    isolate, context, args[static_cast<int>(I)])...)));
+        }
+    }
+
+    static v8::Local<v8::FunctionTemplate> GetFunctionTemplate(v8::Isolate *isolate, CallbackEntry &entry)
+    {
+        if (entry.function_template.IsEmpty())
+        {
+            const v8::Local<v8::External> data = v8::External::New(isolate, entry.target.get());
+            if (entry.fast_function.address() != nullptr)
+            {
+                entry.function_template.Reset(isolate, v8::FunctionTemplate::New(
+                                                  isolate, entry.invoker, data, v8::Local<v8::Signature>(), 0,
+                                                  v8::ConstructorBehavior::kThrow,
+                                                  v8::SideEffectType::kHasSideEffect, &entry.fast_function));
+            } else
+            {
+                entry.function_template.Reset(isolate, v8::FunctionTemplate::New(isolate, entry.invoker, data));
+            }
+        }
+        return entry.function_template.Get(isolate);
+    }
 };
@@ -1,18 +1,36 @@
 #pragma once
 #include <future>
 #include <string>
+#include <span>
 #include <memory>
 #include <v8.h>
 #include <libplatform/libplatform.h>
 #include <iostream>
 #include <nlohmann/json.hpp>
 #include <utility>
+#include <unordered_map>
+#include <queue>
+#include <iterator>
+#include <cstring>
 #include "V8PlatformContext.h"
 #include "V8JavascriptValueWrapper.h"
 #include "V8CallbackHandler.h"
 #include "AsyncExecutor.h"
+#include "V8ExternalString.h"
+#include "V8JsonConversion.h"
+#include "V8SlabAllocator.h"
+#include "V8SharedBufferRegistry.h"
+#include "V8NativeObject.h"
 using json = nlohmann::json;
 
+struct V8EngineBootstrap
+{
+    // Library sources evaluated, in order, in every freshly created context.
+    std::vector<std::string> scripts;
+    // Snippets run after the scripts so hot functions leave the interpreter tier before the first real request.
+    std::vector<std::string> warmup_calls;
+    int warmup_iterations = 1;
+};
 
 class V8EngineContext: public AsyncExecutor, public std::enable_shared_from_this<V8EngineContext>
 {
@@ -20,8 +38,18 @@ class V8EngineContext: public AsyncExecutor, public std::enable_shared_from_this
     std::shared_ptr<v8::Platform> platform;
     v8::Isolate *isolate{};
     std::shared_ptr<v8::Global<v8::Context> > context;
-    std::unique_ptr<v8::ArrayBuffer::Allocator> allocator;
+    std::shared_ptr<v8::ArrayBuffer::Allocator> allocator;
     V8CallbackManager callback_manager_;
+    V8ValueSlotTable value_slots_;
+    V8KeyCache key_cache_;
+    V8NativeObjectFactory native_objects_;
+    std::shared_ptr<const V8EngineBootstrap> bootstrap_;
+    std::shared_ptr<const V8SharedBufferRegistry> shared_buffers_;
+    // Contexts of sessions that are not current; the current one lives in context, under active_session_.
+    std::unordered_map<std::string, v8::Global<v8::Context> > session_contexts_;
+    std::string active_session_;
+    // Callback targets that functions in a session's context may call, kept until the session is dropped.
+    std::unordered_map<std::string, std::vector<std::shared_ptr<void> > > session_callbacks_;
 
     std::queue<TaskFunction> task_queue;
     std::mutex queue_mutex;
@@ -32,13 +60,12 @@ class V8EngineContext: public AsyncExecutor, public std::enable_shared_from_this
 
     void ExecutionLoop()
     {
-        allocator = std::unique_ptr<v8::ArrayBuffer::Allocator>(v8::ArrayBuffer::Allocator::NewDefaultAllocator());
-
         v8::Isolate::CreateParams create_params;
-        create_params.array_buffer_allocator = allocator.get();
+        create_params.array_buffer_allocator_shared = allocator;
 
         // Create the isolate
         isolate = v8::Isolate::New(create_params);
+        isolate->SetData(V8KeyCache::kIsolateDataSlot, &key_cache_);
 
         while (!should_stop)
         {
@@ -52,6 +79,7 @@ class V8EngineContext: public AsyncExecutor, public std::enable_shared_from_this
             }
             {
                 v8::Isolate::Scope isolate_scope(isolate);
+                value_slots_.Drain();
                 task();
             }
 
@@ -63,7 +91,8 @@ class V8EngineContext: public AsyncExecutor, public std::enable_shared_from_this
 
 public:
     explicit V8EngineContext(const V8PlatformContext &platform)
-        : platform(platform.GetPlatform()), context(std::make_shared<v8::Global<v8::Context> >())
+        : platform(platform.GetPlatform()), context(std::make_shared<v8::Global<v8::Context> >()),
+          allocator(platform.GetArrayBufferAllocator())
     {
         execution_thread = std::thread(&V8EngineContext::ExecutionLoop, this);
     }
@@ -73,6 +102,12 @@ public:
         V8EngineContext::ExecuteAsync([this]()
         {
             // Dispose of persistent handles first
+            callback_manager_.DetachTargets();
+            session_callbacks_.clear();
+            value_slots_.Clear();
+            key_cache_.Clear();
+            native_objects_.Clear();
+            session_contexts_.clear();
             context->Reset();
             // Dispose of the isolate
             isolate->Dispose();
@@ -101,21 +136,88 @@ public:
 
     void Reset()
     {
-        ExecuteAsync([this]()
+        ResetAsync();
+    }
+
+    // Replaces the context and runs the bootstrap scripts in it. The future reports whether all of them succeeded.
+    // A current session context is set aside instead of being discarded.
+    std::future<bool> ResetAsync()
+    {
+        std::shared_ptr<std::promise<bool> > promise = std::make_shared<std::promise<bool> >();
+        std::future<bool> future = promise->get_future();
+        ExecuteAsync([this, promise]()
         {
+            StashActiveSession();
+            promise->set_value(NewContext());
+        });
 
-            v8::HandleScope handle_scope(isolate);
-            ClearCallbacks();
-            if (!context->IsEmpty()) {
+        return future;
+    }
+
+    // Makes the persistent context of session key current, creating and bootstrapping it on first use. Returns
+    // whether the session already existed, i.e. its JS state survived. Wrappers and callbacks act on whichever
+    // context is current, so register a session's callbacks again after activating it if another session or a
+    // pool user ran on the engine meanwhile.
+    bool ActivateSession(const std::string &key)
+    {
+        std::promise<bool> promise;
+        std::future<bool> future = promise.get_future();
+        ExecuteAsync([this, &key, &promise]()
+        {
+            if (active_session_ == key && !context->IsEmpty())
+            {
+                promise.set_value(true);
+                return;
+            }
+            StashActiveSession();
+            const auto it = session_contexts_.find(key);
+            if (it != session_contexts_.end())
+            {
+                *context = std::move(it->second);
+                session_contexts_.erase(it);
+                active_session_ = key;
+                promise.set_value(true);
+                return;
+            }
+            NewContext();
+            active_session_ = key;
+            promise.set_value(false);
+        });
+        return future.get();
+    }
+
+    // Discards the session's context and everything its scripts kept alive.
+    void DropSession(const std::string &key)
+    {
+        ExecuteAsync([this, key]()
+        {
+            if (active_session_ == key)
+            {
                 context->Reset();
+                callback_manager_.DetachTargets();
+                active_session_.clear();
+            } else
+            {
+                session_contexts_.erase(key);
             }
+            session_callbacks_.erase(key);
+        });
+    }
+
+    void SetBootstrap(std::shared_ptr<const V8EngineBootstrap> bootstrap)
+    {
+        ExecuteAsync([this, bootstrap = std::move(bootstrap)]()
+        {
+            bootstrap_ = bootstrap;
+        });
+    }
 
-            // Create a new context
-            v8::Local<v8::Context> local_context = v8::Context::New(isolate);
-            // Create a persistent handle from the local handle
-            context->Reset(isolate, local_context);
-            InitializeConsole();
-            return nullptr;
+    // Buffers of the registry become globals of every context created by the following resets.
+    void SetSharedBuffers(std::shared_ptr<const V8SharedBufferRegistry> shared_buffers)
+    {
+        ExecuteAsync([this, shared_buffers = std::move(shared_buffers)]()
+        {
+            shared_buffers_ = shared_buffers;
         });
     }
 
@@ -137,12 +239,42 @@ public:
 
     void RegisterCallback(const std::string &name, V8CallbackManager::JavascriptCallback callback)
     {
-        callback_manager_.RegisterCallback(name, std::move(callback));
+        // Registered on the execution thread and installed once, instead of being re-exposed on every ExecuteJS
+        ExecuteAsync([this, name, callback = std::move(callback)]()
+        {
+            callback_manager_.RegisterCallback(name, callback);
+            InstallRegisteredCallback(name);
+        });
+    }
+
+    void RegisterCallback(const std::string &name, V8CallbackManager::JavascriptCallback callback,
+                          const v8::CFunction &fast_function)
+    {
+        ExecuteAsync([this, name, callback = std::move(callback), fast_function]()
+        {
+            callback_manager_.RegisterCallback(name, callback, fast_function);
+            InstallRegisteredCallback(name);
+        });
+    }
+
+    // Typed binding: RegisterFunction("add", &Add) or RegisterFunction("area", &Shape::Area, &shape).
+    template<typename... Binding>
+    void RegisterFunction(const std::string &name, Binding... binding)
+    {
+        ExecuteAsync([this, name, binding...]()
+        {
+            callback_manager_.RegisterFunction(name, binding...);
+            InstallRegisteredCallback(name);
+        });
     }
 
+    // Later contexts start without the callbacks; the current one keeps calling them until it is replaced.
     void ClearCallbacks()
     {
-        callback_manager_.ClearCallbacks();
+        ExecuteAsync([this]()
+        {
+            callback_manager_.ClearCallbacks();
+        });
     }
 
     std::shared_ptr<JSValueWrapper> ExecuteJS(const std::string &js_code)
@@ -161,38 +293,44 @@ public:
             v8::HandleScope handle_scope(isolate);
             const v8::Local<v8::Context> local_context = GetLocalContext();
             v8::Context::Scope context_scope(local_context);
-            const v8::TryCatch try_catch(isolate);
             const v8::Local<v8::String> source = v8::String::NewFromUtf8(isolate, js_code.c_str()).ToLocalChecked();
-            v8::MaybeLocal<v8::Script> maybe_script = v8::Script::Compile(local_context, source);
-
-            if (maybe_script.IsEmpty())
-            {
-                v8::String::Utf8Value error(isolate, try_catch.Exception());
-                std::cerr << "Error compiling JS code: " << *error << std::endl;
-                promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, v8::Undefined(isolate), shared_from_this()));
-                return;
-            }
+            CompileAndRun(local_context, source, promise);
+        });
 
-            v8::Local<v8::Script> script = maybe_script.ToLocalChecked();
+        return future;
+    }
 
-            callback_manager_.ExposeCallbacks(isolate, local_context);
-            v8::MaybeLocal<v8::Value> maybe_result = script->Run(local_context);
+    std::shared_ptr<JSValueWrapper> ExecuteJS(std::shared_ptr<const std::string> js_code)
+    {
+        std::future<std::shared_ptr<JSValueWrapper> > future = ExecuteJSAsync(std::move(js_code));
+        return future.get();
+    }
 
-            if (try_catch.HasCaught())
-            {
-                v8::String::Utf8Value error(isolate, try_catch.Exception());
-                std::cerr << "JavaScript error: " << *error << std::endl;
-                promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, v8::Undefined(isolate), shared_from_this()));
-                return;
-            }
+    std::future<std::shared_ptr<JSValueWrapper> > ExecuteJSAsync(std::shared_ptr<const std::string> js_code)
+    {
+        const size_t length = js_code->size();
+        return ExecuteJSAsync(std::shared_ptr<const char>(js_code, js_code->data()), length);
+    }
 
-            if (maybe_result.IsEmpty())
+    // Runs source owned by the caller without copying it. Large ASCII sources are handed to V8 as an external
+    // string; pass a memory-mapped file by giving the shared_ptr a deleter that unmaps it.
+    std::future<std::shared_ptr<JSValueWrapper> > ExecuteJSAsync(std::shared_ptr<const char> js_code, size_t length)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        ExecuteAsync([this, js_code = std::move(js_code), length, promise]()
+        {
+            v8::HandleScope handle_scope(isolate);
+            const v8::Local<v8::Context> local_context = GetLocalContext();
+            v8::Context::Scope context_scope(local_context);
+            v8::Local<v8::String> source;
+            if (!V8ExternalOneByteString::NewFromUtf8(isolate, js_code, length).ToLocal(&source))
             {
-                promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, v8::Undefined(isolate), shared_from_this()));
+                std::cerr << "Error creating JS source string" << std::endl;
+                promise->set_value(MakeWrapper(v8::Undefined(isolate)));
                 return;
             }
-
-            promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, maybe_result.ToLocalChecked(), shared_from_this()));
+            CompileAndRun(local_context, source, promise);
         });
 
         return future;
@@ -223,7 +361,7 @@ public:
             {
                 v8::String::Utf8Value error(isolate, try_catch.Exception());
                 std::cerr << "Error compiling JS code: " << *error << std::endl;
-                promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, v8::Undefined(isolate), shared_from_this()));
+                promise->set_value(MakeWrapper(v8::Undefined(isolate)));
                 return;
             }
 
@@ -234,12 +372,268 @@ public:
             {
                 v8::String::Utf8Value error(isolate, try_catch.Exception());
                 std::cerr << "Error executing JS code: " << *error << std::endl;
-                promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, v8::Undefined(isolate), shared_from_this()));
+                promise->set_value(MakeWrapper(v8::Undefined(isolate)));
                 return;
             }
 
             v8::Local<v8::Value> result = maybe_result.ToLocalChecked();
-            promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, result, shared_from_this()));
+            promise->set_value(MakeWrapper(result));
+        });
+
+        return future;
+    }
+
+    // Builds the value straight from the document, without compiling anything.
+    std::shared_ptr<JSValueWrapper> CreateJSValueFromJson(const nlohmann::json &value)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        // The document is read in place because this call blocks until the task has run
+        ExecuteAsync([this, &value, promise]()
+        {
+            BuildFromJson(value, promise);
+        });
+        return future.get();
+    }
+
+    std::future<std::shared_ptr<JSValueWrapper> > CreateJSValueFromJsonAsync(nlohmann::json value)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        ExecuteAsync([this, value = std::move(value), promise]()
+        {
+            BuildFromJson(value, promise);
+        });
+
+        return future;
+    }
+
+    // Parses JSON text with V8's JSON parser. Unlike CreateJSValue, the input is never evaluated as code,
+    // so it is safe for untrusted payloads.
+    std::shared_ptr<JSValueWrapper> CreateJSValueFromJsonText(std::string_view json_text)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        // The view stays valid because this call blocks until the task has run
+        ExecuteAsync([this, json_text, promise]()
+        {
+            ParseJsonText(json_text.data(), json_text.size(), promise);
+        });
+        return future.get();
+    }
+
+    std::future<std::shared_ptr<JSValueWrapper> > CreateJSValueFromJsonTextAsync(std::string json_text)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        ExecuteAsync([this, json_text = std::move(json_text), promise]()
+        {
+            ParseJsonText(json_text.data(), json_text.size(), promise);
+        });
+
+        return future;
+    }
+
+    // Decodes MessagePack straight into V8 values. Malformed input is reported and yields an Undefined wrapper,
+    // like a failed CreateJSValue.
+    std::shared_ptr<JSValueWrapper> CreateJSValueFromMsgPack(std::span<const uint8_t> bytes)
+    {
+        return DecodeBinary<V8MsgPackReader>(bytes, "MessagePack");
+    }
+
+    std::future<std::shared_ptr<JSValueWrapper> > CreateJSValueFromMsgPackAsync(std::vector<uint8_t> bytes)
+    {
+        return DecodeBinaryAsync<V8MsgPackReader>(std::move(bytes), "MessagePack");
+    }
+
+    std::shared_ptr<JSValueWrapper> CreateJSValueFromCbor(std::span<const uint8_t> bytes)
+    {
+        return DecodeBinary<V8CborReader>(bytes, "CBOR");
+    }
+
+    std::future<std::shared_ptr<JSValueWrapper> > CreateJSValueFromCborAsync(std::vector<uint8_t> bytes)
+    {
+        return DecodeBinaryAsync<V8CborReader>(std::move(bytes), "CBOR");
+    }
+
+    // Large immutable text as a JS string that V8 reads in place instead of copying into its heap; text stays
+    // alive until V8 drops the string. UTF-8 is only kept external when it is ASCII and at least
+    // V8ExternalOneByteString::kMinExternalLength bytes long, otherwise it is copied as CreateJSValue would.
+    std::shared_ptr<JSValueWrapper> CreateExternalString(std::shared_ptr<const std::string> text)
+    {
+        return NewStringValue([&text](v8::Isolate *engine_isolate)
+        {
+            return V8ExternalOneByteString::NewFromUtf8(
+                engine_isolate, std::shared_ptr<const char>(text, text->data()), text->size());
+        });
+    }
+
+    // Latin-1 text is V8's own one-byte encoding, so it is kept external at any content.
+    std::shared_ptr<JSValueWrapper> CreateExternalLatin1String(std::shared_ptr<const std::string> text)
+    {
+        return NewStringValue([&text](v8::Isolate *engine_isolate)
+        {
+            return V8ExternalOneByteString::NewFromLatin1(
+                engine_isolate, std::shared_ptr<const char>(text, text->data()), text->size());
+        });
+    }
+
+    std::shared_ptr<JSValueWrapper> CreateExternalString(std::shared_ptr<const std::u16string> text)
+    {
+        return NewStringValue([&text](v8::Isolate *engine_isolate)
+        {
+            return V8ExternalTwoByteString::New(
+                engine_isolate, std::shared_ptr<const char16_t>(text, text->data()), text->size());
+        });
+    }
+
+    // Memory from the engines' shared ArrayBuffer allocator, to be filled natively and then wrapped without
+    // copying by the V8NativeBuffer overloads of CreateArrayBuffer/CreateTypedArray.
+    [[nodiscard]] V8NativeBuffer AllocateBuffer(size_t byte_length) const
+    {
+        std::shared_ptr<v8::ArrayBuffer::Allocator> buffer_allocator = allocator;
+        void *data = buffer_allocator->AllocateUninitialized(byte_length);
+        if (data == nullptr && byte_length != 0)
+        {
+            throw std::bad_alloc();
+        }
+        return {std::shared_ptr<void>(data, [buffer_allocator, byte_length](void *memory)
+        {
+            buffer_allocator->Free(memory, byte_length);
+        }), byte_length};
+    }
+
+    // Wraps the whole buffer as an ArrayBuffer without copying; the memory is released once V8 frees the buffer.
+    std::shared_ptr<JSValueWrapper> CreateArrayBuffer(const V8NativeBuffer &buffer)
+    {
+        return WrapBackingStore(NewExternalBackingStore(buffer.memory_, buffer.data(), buffer.size()), [](auto array_buffer)
+        {
+            return v8::Local<v8::Value>(array_buffer);
+        });
+    }
+
+    // Wraps caller-owned memory as an ArrayBuffer; owner is released once V8 frees the buffer. With
+    // V8_ENABLE_SANDBOX, V8 rejects memory outside its sandbox, so the bytes are copied into allocator memory and
+    // owner is released right away; use AllocateBuffer to avoid the copy.
+    std::shared_ptr<JSValueWrapper> CreateArrayBuffer(std::shared_ptr<void> owner, void *data, size_t byte_length)
+    {
+        return WrapBackingStore(AdoptOrCopy(std::move(owner), data, byte_length), [](auto array_buffer)
+        {
+            return v8::Local<v8::Value>(array_buffer);
+        });
+    }
+
+    // ArrayBuffer allocated by V8; fill it in place through GetBackingStore() on the result.
+    std::shared_ptr<JSValueWrapper> CreateArrayBuffer(size_t byte_length)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        ExecuteAsync([this, byte_length, promise]()
+        {
+            v8::HandleScope handle_scope(isolate);
+            v8::Context::Scope context_scope(GetLocalContext());
+            promise->set_value(MakeWrapper(v8::ArrayBuffer::New(isolate, byte_length)));
+        });
+        return future.get();
+    }
+
+    // The buffer's elements as the typed array matching T (Float64Array for double, ...), without copying.
+    template<typename T>
+    std::shared_ptr<JSValueWrapper> CreateTypedArray(const V8NativeBuffer &buffer)
+    {
+        const size_t length = buffer.size() / sizeof(T);
+        return WrapBackingStore(NewExternalBackingStore(buffer.memory_, buffer.data(), length * sizeof(T)),
+                                [length](v8::Local<v8::ArrayBuffer> array_buffer)
+                                {
+                                    return v8::Local<v8::Value>(V8NumericArray<T>::NewTypedArray(array_buffer, length));
+                                });
+    }
+
+    // Wraps length elements of caller-owned memory as the typed array matching T; copied under V8_ENABLE_SANDBOX
+    // like CreateArrayBuffer(owner, data, byte_length).
+    template<typename T>
+    std::shared_ptr<JSValueWrapper> CreateTypedArray(std::shared_ptr<void> owner, T *data, size_t length)
+    {
+        return WrapBackingStore(AdoptOrCopy(std::move(owner), data, length * sizeof(T)),
+                                [length](v8::Local<v8::ArrayBuffer> array_buffer)
+                                {
+                                    return v8::Local<v8::Value>(V8NumericArray<T>::NewTypedArray(array_buffer, length));
+                                });
+    }
+
+    // JS object whose properties are read from source only when a script touches them, so building it costs the
+    // same for ten records as for ten million. Read fields are cached on the object and never re-read.
+    std::shared_ptr<JSValueWrapper> CreateNativeObject(std::shared_ptr<V8NativeDataSource> source)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        ExecuteAsync([this, source = std::move(source), promise]()
+        {
+            v8::HandleScope handle_scope(isolate);
+            const v8::Local<v8::Context> local_context = GetLocalContext();
+            v8::Context::Scope context_scope(local_context);
+            v8::Local<v8::Object> object;
+            if (!native_objects_.NewInstance(isolate, local_context, source).ToLocal(&object))
+            {
+                std::cerr << "Failed to create native object" << std::endl;
+                promise->set_value(MakeWrapper(v8::Undefined(isolate)));
+                return;
+            }
+            promise->set_value(MakeWrapper(object));
+        });
+        return future.get();
+    }
+
+    // Same lazy object, set as global `name` of the current context; like every global it is gone after Reset().
+    bool ExposeNativeObject(const std::string &name, std::shared_ptr<V8NativeDataSource> source)
+    {
+        std::promise<bool> promise;
+        std::future<bool> future = promise.get_future();
+        ExecuteAsync([this, &name, &source, &promise]()
+        {
+            v8::HandleScope handle_scope(isolate);
+            const v8::Local<v8::Context> local_context = GetLocalContext();
+            v8::Context::Scope context_scope(local_context);
+            v8::Local<v8::Object> object;
+            if (!native_objects_.NewInstance(isolate, local_context, std::move(source)).ToLocal(&object) ||
+                local_context->Global()->Set(local_context, V8KeyCache::Internalize(isolate, name), object).
+                IsNothing())
+            {
+                std::cerr << "Failed to expose native object " << name << std::endl;
+                promise.set_value(false);
+                return;
+            }
+            promise.set_value(true);
+        });
+        return future.get();
+    }
+
+    // Recreates a value serialized by JSValueWrapper::Serialize, typically on another engine of the pool.
+    std::shared_ptr<JSValueWrapper> Deserialize(const V8SerializedValue &serialized)
+    {
+        std::future<std::shared_ptr<JSValueWrapper> > future = DeserializeAsync(serialized);
+        return future.get();
+    }
+
+    std::future<std::shared_ptr<JSValueWrapper> > DeserializeAsync(V8SerializedValue serialized)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        ExecuteAsync([this, serialized = std::move(serialized), promise]()
+        {
+            v8::HandleScope handle_scope(isolate);
+            const v8::Local<v8::Context> local_context = GetLocalContext();
+            v8::Context::Scope context_scope(local_context);
+            const v8::TryCatch try_catch(isolate);
+            v8::Local<v8::Value> result;
+            if (!serialized.Read(isolate, local_context).ToLocal(&result))
+            {
+                v8::String::Utf8Value error(isolate, try_catch.Exception());
+                std::cerr << "Error deserializing value: " << (*error ? *error : "invalid data") << std::endl;
+                promise->set_value(MakeWrapper(v8::Undefined(isolate)));
+                return;
+            }
+            promise->set_value(MakeWrapper(result));
         });
 
         return future;
@@ -270,7 +664,7 @@ public:
             if (!local_context->Global()->Get(local_context, func_name).ToLocal(&func_val) || !func_val->IsFunction())
             {
                 std::cerr << "Function " << function_name << " not found or is not a function" << std::endl;
-                promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, v8::Undefined(isolate), shared_from_this()));
+                promise->set_value(MakeWrapper(v8::Undefined(isolate)));
                 return;
             }
             // Convert JSValueWrapper instances to v8::Local<v8::Value> within the execution thread
@@ -289,20 +683,111 @@ public:
             {
                 v8::String::Utf8Value error(isolate, try_catch.Exception());
                 std::cerr << "Error calling function " << function_name << ": " << *error << std::endl;
-                promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, v8::Undefined(isolate), shared_from_this()));
+                promise->set_value(MakeWrapper(v8::Undefined(isolate)));
                 return;
             }
             v8::Local<v8::Value> result_value;
             if (!result.ToLocal(&result_value))
             {
-                promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, v8::Undefined(isolate), shared_from_this()));
+                promise->set_value(MakeWrapper(v8::Undefined(isolate)));
                 return;
             }
-            promise->set_value(std::make_shared<JSValueWrapper>(isolate, context, result_value, shared_from_this()));
+            promise->set_value(MakeWrapper(result_value));
+        });
+        return future;
+    }
+
+    // Calls the global function once per input inside a single engine task: one hop and no wrappers for the
+    // whole batch. Inputs convert through V8Converter (JSON, reflected structs, vectors, spans of numbers as
+    // typed arrays, ...) and results likewise into Out. A missing function or a throwing call fails the whole
+    // batch with std::runtime_error.
+    template<typename Out = nlohmann::json, typename In>
+    std::vector<Out> CallJSFunctionBatch(const std::string &function_name, std::span<const In> inputs)
+    {
+        return CallJSFunctionBatchAsync<Out, In>(function_name, inputs).get();
+    }
+
+    template<typename Out = nlohmann::json, typename In>
+    std::vector<Out> CallJSFunctionBatch(const std::string &function_name, const std::vector<In> &inputs)
+    {
+        return CallJSFunctionBatch<Out, In>(function_name, std::span<const In>(inputs));
+    }
+
+    // inputs must stay alive until the future is ready.
+    template<typename Out = nlohmann::json, typename In>
+    std::future<std::vector<Out> > CallJSFunctionBatchAsync(std::string function_name, std::span<const In> inputs)
+    {
+        std::shared_ptr<std::promise<std::vector<Out> > > promise = std::make_shared<std::promise<std::vector<Out> > >();
+        std::future<std::vector<Out> > future = promise->get_future();
+        ExecuteAsync([this, promise, function_name = std::move(function_name), inputs]()
+        {
+            v8::HandleScope handle_scope(isolate);
+            const v8::Local<v8::Context> local_context = GetLocalContext();
+            v8::Context::Scope context_scope(local_context);
+            const v8::TryCatch try_catch(isolate);
+            try
+            {
+                const v8::Local<v8::Function> func = GetGlobalFunction(local_context, function_name);
+                std::vector<Out> results;
+                results.reserve(inputs.size());
+                for (size_t i = 0; i < inputs.size(); ++i)
+                {
+                    // Per-call scope, so handle usage doesn't grow with the batch
+                    v8::HandleScope call_scope(isolate);
+                    v8::Local<v8::Value> argument = V8Converter<In>::ToV8(isolate, local_context, inputs[i]);
+                    v8::Local<v8::Value> result;
+                    if (!func->Call(local_context, v8::Undefined(isolate), 1, &argument).ToLocal(&result))
+                    {
+                        const v8::String::Utf8Value error(isolate, try_catch.Exception());
+                        throw std::runtime_error("Error calling function " + function_name + " on input " +
+                                                 std::to_string(i) + ": " + (*error ? *error : "unknown error"));
+                    }
+                    results.push_back(V8Converter<Out>::FromV8(isolate, local_context, result));
+                }
+                promise->set_value(std::move(results));
+            } catch (const std::exception &)
+            {
+                promise->set_exception(std::current_exception());
+            }
         });
         return future;
     }
 
+    // Calls the global function with arguments converted through V8Converter and converts the result into Out,
+    // in one task and without wrappers. A missing function or a throwing call raises std::runtime_error.
+    template<typename Out = nlohmann::json, typename... Args>
+    Out CallJSFunctionTyped(const std::string &function_name, const Args &... args)
+    {
+        std::promise<Out> promise;
+        std::future<Out> future = promise.get_future();
+        ExecuteAsync([this, &promise, &function_name, &args...]()
+        {
+            v8::HandleScope handle_scope(isolate);
+            const v8::Local<v8::Context> local_context = GetLocalContext();
+            v8::Context::Scope context_scope(local_context);
+            const v8::TryCatch try_catch(isolate);
+            try
+            {
+                const v8::Local<v8::Function> func = GetGlobalFunction(local_context, function_name);
+                // Trailing slot keeps the array non-empty for functions without arguments
+                v8::Local<v8::Value> argv[] = {V8Converter<Args>::ToV8(isolate, local_context, args)...,
+                                               v8::Undefined(isolate)};
+                v8::Local<v8::Value> result;
+                if (!func->Call(local_context, v8::Undefined(isolate), sizeof...(Args), argv).ToLocal(&result))
+                {
+                    const v8::String::Utf8Value error(isolate, try_catch.Exception());
+                    throw std::runtime_error("Error calling function " + function_name + ": " +
+                                             (*error ? *error : "unknown error"));
+                }
+                promise.set_value(V8Converter<Out>::FromV8(isolate, local_context, result));
+            } catch (const std::exception &)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        });
+        return future.get();
+    }
+
     [[nodiscard]] v8::Local<v8::Context> GetLocalContext() const
     {
         return context->Get(isolate);
@@ -321,6 +806,308 @@ public:
     }
 
 private:
+    // Runs on the engine thread, where nothing catches: a full slot table is reported like any other failed
+    // result, as an Undefined wrapper.
+    std::shared_ptr<JSValueWrapper> MakeWrapper(const v8::Local<v8::Value> &value)
+    {
+        try
+        {
+            return std::allocate_shared<JSValueWrapper>(V8SlabAllocator<JSValueWrapper>(), isolate, context.get(),
+                                                        value, shared_from_this(), &value_slots_);
+        } catch (const std::runtime_error &e)
+        {
+            std::cerr << "Failed to wrap JS value: " << e.what() << std::endl;
+            // Undefined is kept inline and takes no slot
+            return std::allocate_shared<JSValueWrapper>(V8SlabAllocator<JSValueWrapper>(), isolate, context.get(),
+                                                        v8::Undefined(isolate), shared_from_this(), &value_slots_);
+        }
+    }
+
+    v8::Local<v8::Function> GetGlobalFunction(const v8::Local<v8::Context> &local_context,
+                                              const std::string &function_name)
+    {
+        v8::Local<v8::Value> func_val;
+        if (!local_context->Global()->Get(local_context, V8KeyCache::Internalize(isolate, function_name)).
+             ToLocal(&func_val) || !func_val->IsFunction())
+        {
+            throw std::runtime_error("Function " + function_name + " not found or is not a function");
+        }
+        return func_val.As<v8::Function>();
+    }
+
+    void InstallRegisteredCallback(const std::string &name)
+    {
+        if (context->IsEmpty())
+        {
+            return;
+        }
+        v8::HandleScope handle_scope(isolate);
+        const v8::Local<v8::Context> local_context = GetLocalContext();
+        v8::Context::Scope context_scope(local_context);
+        callback_manager_.InstallCallback(isolate, local_context, name);
+    }
+
+    static std::shared_ptr<v8::BackingStore> NewExternalBackingStore(std::shared_ptr<void> owner, void *data,
+                                                                     size_t byte_length)
+    {
+        // The deleter may run on any thread once the last ArrayBuffer using the store is gone
+        return v8::ArrayBuffer::NewBackingStore(data, byte_length, [](void *, size_t, void *deleter_data)
+        {
+            delete static_cast<std::shared_ptr<void> *>(deleter_data);
+        }, new std::shared_ptr<void>(std::move(owner)));
+    }
+
+    std::shared_ptr<v8::BackingStore> AdoptOrCopy(std::shared_ptr<void> owner, void *data, size_t byte_length) const
+    {
+#ifdef V8_ENABLE_SANDBOX
+        const V8NativeBuffer copy = AllocateBuffer(byte_length);
+        if (byte_length != 0)
+        {
+            std::memcpy(copy.data(), data, byte_length);
+        }
+        return NewExternalBackingStore(copy.memory_, copy.data(), byte_length);
+#else
+        return NewExternalBackingStore(std::move(owner), data, byte_length);
+#endif
+    }
+
+    template<typename MakeValue>
+    std::shared_ptr<JSValueWrapper> WrapBackingStore(std::shared_ptr<v8::BackingStore> backing_store,
+                                                     MakeValue make_value)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        ExecuteAsync([this, &backing_store, &make_value, promise]()
+        {
+            v8::HandleScope handle_scope(isolate);
+            v8::Context::Scope context_scope(GetLocalContext());
+            promise->set_value(MakeWrapper(make_value(v8::ArrayBuffer::New(isolate, backing_store))));
+        });
+        return future.get();
+    }
+
+    void BuildFromJson(const nlohmann::json &value,
+                       const std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper> > > &promise)
+    {
+        v8::HandleScope handle_scope(isolate);
+        const v8::Local<v8::Context> local_context = GetLocalContext();
+        v8::Context::Scope context_scope(local_context);
+        try
+        {
+            promise->set_value(MakeWrapper(V8Converter<nlohmann::json>::ToV8(isolate, local_context, value)));
+        } catch (const std::exception &e)
+        {
+            std::cerr << "Error creating JS value from JSON: " << e.what() << std::endl;
+            promise->set_value(MakeWrapper(v8::Undefined(isolate)));
+        }
+    }
+
+    void ParseJsonText(const char *data, size_t length,
+                       const std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper> > > &promise)
+    {
+        v8::HandleScope handle_scope(isolate);
+        const v8::Local<v8::Context> local_context = GetLocalContext();
+        v8::Context::Scope context_scope(local_context);
+        const v8::TryCatch try_catch(isolate);
+        v8::Local<v8::String> source;
+        v8::Local<v8::Value> result;
+        if (!v8::String::NewFromUtf8(isolate, data, v8::NewStringType::kNormal, static_cast<int>(length)).
+             ToLocal(&source) || !v8::JSON::Parse(local_context, source).ToLocal(&result))
+        {
+            v8::String::Utf8Value error(isolate, try_catch.Exception());
+            std::cerr << "Error parsing JSON: " << (*error ? *error : "invalid input") << std::endl;
+            promise->set_value(MakeWrapper(v8::Undefined(isolate)));
+            return;
+        }
+        promise->set_value(MakeWrapper(result));
+    }
+
+    template<typename MakeString>
+    std::shared_ptr<JSValueWrapper> NewStringValue(const MakeString &make_string)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        ExecuteAsync([this, &make_string, promise]()
+        {
+            v8::HandleScope handle_scope(isolate);
+            v8::Context::Scope context_scope(GetLocalContext());
+            v8::Local<v8::String> string;
+            if (!make_string(isolate).ToLocal(&string))
+            {
+                std::cerr << "Failed to create external string" << std::endl;
+                promise->set_value(MakeWrapper(v8::Undefined(isolate)));
+                return;
+            }
+            promise->set_value(MakeWrapper(string));
+        });
+        return future.get();
+    }
+
+    template<typename Reader>
+    std::shared_ptr<JSValueWrapper> DecodeBinary(std::span<const uint8_t> bytes, const char *format)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        // The span stays valid because this call blocks until the task has run
+        ExecuteAsync([this, bytes, format, promise]()
+        {
+            ReadBinary<Reader>(bytes.data(), bytes.size(), format, promise);
+        });
+        return future.get();
+    }
+
+    template<typename Reader>
+    std::future<std::shared_ptr<JSValueWrapper> > DecodeBinaryAsync(std::vector<uint8_t> bytes, const char *format)
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper>>> promise = std::make_shared<std::promise<std::shared_ptr<JSValueWrapper>>>();
+        std::future<std::shared_ptr<JSValueWrapper> > future = promise->get_future();
+        ExecuteAsync([this, bytes = std::move(bytes), format, promise]()
+        {
+            ReadBinary<Reader>(bytes.data(), bytes.size(), format, promise);
+        });
+        return future;
+    }
+
+    template<typename Reader>
+    void ReadBinary(const uint8_t *data, size_t size, const char *format,
+                    const std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper> > > &promise)
+    {
+        v8::HandleScope handle_scope(isolate);
+        const v8::Local<v8::Context> local_context = GetLocalContext();
+        v8::Context::Scope context_scope(local_context);
+        try
+        {
+            promise->set_value(MakeWrapper(Reader::Read(isolate, local_context, data, size)));
+        } catch (const std::exception &e)
+        {
+            std::cerr << "Error decoding " << format << ": " << e.what() << std::endl;
+            promise->set_value(MakeWrapper(v8::Undefined(isolate)));
+        }
+    }
+
+    void CompileAndRun(const v8::Local<v8::Context> &local_context, const v8::Local<v8::String> &source,
+                       const std::shared_ptr<std::promise<std::shared_ptr<JSValueWrapper> > > &promise)
+    {
+        const v8::TryCatch try_catch(isolate);
+        v8::MaybeLocal<v8::Script> maybe_script = v8::Script::Compile(local_context, source);
+
+        if (maybe_script.IsEmpty())
+        {
+            v8::String::Utf8Value error(isolate, try_catch.Exception());
+            std::cerr << "Error compiling JS code: " << *error << std::endl;
+            promise->set_value(MakeWrapper(v8::Undefined(isolate)));
+            return;
+        }
+
+        v8::Local<v8::Script> script = maybe_script.ToLocalChecked();
+        v8::MaybeLocal<v8::Value> maybe_result = script->Run(local_context);
+
+        if (try_catch.HasCaught())
+        {
+            v8::String::Utf8Value error(isolate, try_catch.Exception());
+            std::cerr << "JavaScript error: " << *error << std::endl;
+            promise->set_value(MakeWrapper(v8::Undefined(isolate)));
+            return;
+        }
+
+        if (maybe_result.IsEmpty())
+        {
+            promise->set_value(MakeWrapper(v8::Undefined(isolate)));
+            return;
+        }
+
+        promise->set_value(MakeWrapper(maybe_result.ToLocalChecked()));
+    }
+
+    // Sets the current context aside if it belongs to a session, along with the callback targets it may call.
+    // Otherwise those targets are released, as the caller replaces the context right away.
+    void StashActiveSession()
+    {
+        std::vector<std::shared_ptr<void> > targets = callback_manager_.DetachTargets();
+        if (!active_session_.empty() && !context->IsEmpty())
+        {
+            session_contexts_[active_session_] = std::move(*context);
+            std::vector<std::shared_ptr<void> > &kept = session_callbacks_[active_session_];
+            kept.insert(kept.end(), std::make_move_iterator(targets.begin()), std::make_move_iterator(targets.end()));
+        }
+        active_session_.clear();
+    }
+
+    bool NewContext()
+    {
+        v8::HandleScope handle_scope(isolate);
+        // The old context's callbacks go with it
+        callback_manager_.DetachTargets();
+        if (!context->IsEmpty()) {
+            context->Reset();
+        }
+
+        // Create a new context; callbacks registered from now on are installed on it as they come
+        v8::Local<v8::Context> local_context = v8::Context::New(isolate);
+        // Create a persistent handle from the local handle
+        context->Reset(isolate, local_context);
+        InitializeConsole();
+        InjectSharedBuffers(local_context);
+        return RunBootstrap(local_context);
+    }
+
+    void InjectSharedBuffers(const v8::Local<v8::Context> &local_context)
+    {
+        if (!shared_buffers_)
+        {
+            return;
+        }
+        v8::Context::Scope context_scope(local_context);
+        const v8::Local<v8::Object> global = local_context->Global();
+        for (const auto &[name, backing_store]: shared_buffers_->Snapshot())
+        {
+            const v8::Local<v8::String> v8_name = v8::String::NewFromUtf8(isolate, name.c_str()).ToLocalChecked();
+            global->Set(local_context, v8_name, v8::SharedArrayBuffer::New(isolate, backing_store)).Check();
+        }
+    }
+
+    bool RunBootstrap(const v8::Local<v8::Context> &local_context)
+    {
+        if (!bootstrap_)
+        {
+            return true;
+        }
+        v8::Context::Scope context_scope(local_context);
+        for (const auto &script: bootstrap_->scripts)
+        {
+            if (!RunScript(local_context, script, "bootstrap script"))
+            {
+                return false;
+            }
+        }
+        for (int i = 0; i < bootstrap_->warmup_iterations; ++i)
+        {
+            for (const auto &call: bootstrap_->warmup_calls)
+            {
+                if (!RunScript(local_context, call, "warm-up call"))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool RunScript(const v8::Local<v8::Context> &local_context, const std::string &js_code, const char *what)
+    {
+        v8::HandleScope handle_scope(isolate);
+        const v8::TryCatch try_catch(isolate);
+        const v8::Local<v8::String> source = v8::String::NewFromUtf8(isolate, js_code.c_str()).ToLocalChecked();
+        v8::Local<v8::Script> script;
+        if (!v8::Script::Compile(local_context, source).ToLocal(&script) || script->Run(local_context).IsEmpty())
+        {
+            v8::String::Utf8Value error(isolate, try_catch.Exception());
+            std::cerr << "Error running " << what << ": " << *error << std::endl;
+            return false;
+        }
+        return true;
+    }
+
     void InitializeConsole()
     {
         v8::Local<v8::Context> local_context = context->Get(isolate);
@@ -4,11 +4,45 @@
 #pragma once
 
 #include <vector>
-#include <queue>
+#include <deque>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <span>
 #include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
 #include <condition_variable>
 #include <memory>
 #include "V8EngineContext.h"
+#include "V8MapReduce.h"
+#include "V8MemoCache.h"
+
+struct V8SessionOptions
+{
+    // Session contexts kept across the pool; beyond this the least recently used idle session is evicted.
+    size_t capacity = 64;
+    // Evaluated in an evicted session's context; the value is serialized and handed to on_evict.
+    std::string snapshot_expression;
+    std::function<void(const std::string &key, V8SerializedValue state)> on_evict;
+    // Asked for saved state when a session's context is created; a value it returns is deserialized and passed
+    // to the global function restore_function.
+    std::function<std::optional<V8SerializedValue>(const std::string &key)> load_snapshot;
+    std::string restore_function;
+};
+
+struct V8SessionMetrics
+{
+    // Requests served by the context their session already had.
+    uint64_t hits = 0;
+    // Requests that had to create the session's context.
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t live_sessions = 0;
+};
 
 class V8EngineManager
 {
@@ -44,18 +78,77 @@ public:
         V8EngineManager *manager_;
     };
 
-    explicit V8EngineManager(size_t pool_size = std::thread::hardware_concurrency())
+    class V8SessionGuard
+    {
+    public:
+        V8SessionGuard(const std::shared_ptr<V8EngineContext>& engine, V8EngineManager *manager, std::string key)
+        : engine_(engine),
+          manager_(manager),
+          key_(std::move(key))
+        {
+        }
+
+        ~V8SessionGuard()
+        {
+            manager_->returnSession(key_, engine_);
+        }
+
+        V8SessionGuard(const V8SessionGuard &) = delete;
+        V8SessionGuard &operator=(const V8SessionGuard &) = delete;
+        V8SessionGuard(V8SessionGuard &&) = delete;
+        V8SessionGuard &operator=(V8SessionGuard &&) = delete;
+
+        std::shared_ptr<V8EngineContext> get()
+        {
+            return engine_;
+        }
+
+        [[nodiscard]] const std::string &key() const
+        {
+            return key_;
+        }
+
+    private:
+        std::shared_ptr<V8EngineContext> engine_;
+        V8EngineManager *manager_;
+        std::string key_;
+    };
+
+    explicit V8EngineManager(size_t pool_size = std::thread::hardware_concurrency(),
+                             V8EngineBootstrap bootstrap = {})
+        : bootstrap_(std::make_shared<const V8EngineBootstrap>(std::move(bootstrap))),
+          shared_buffers_(std::make_shared<V8SharedBufferRegistry>(platform_context_.GetArrayBufferAllocator()))
     {
+        // Warm all engines in parallel, each on its own execution thread.
+        std::vector<std::future<bool> > warmups;
         for (size_t i = 0; i < pool_size; ++i)
         {
             auto engine = std::make_shared<V8EngineContext>(platform_context_);
-            available_engines_.push(engine);
+            engine->SetBootstrap(bootstrap_);
+            engine->SetSharedBuffers(shared_buffers_);
+            warmups.push_back(engine->ResetAsync());
+            available_engines_.push_back(engine);
             engines_.push_back(engine);
         }
+        bool warm = true;
+        for (auto &warmup: warmups)
+        {
+            if (!warmup.get())
+            {
+                std::cerr << "V8 engine failed to run its bootstrap scripts" << std::endl;
+                warm = false;
+            }
+        }
+        ready_ = warm;
     }
 
     ~V8EngineManager()
     {
+        // Waits for memoized calls running on the pool, and turns later misses into errors
+        {
+            std::unique_lock<std::shared_mutex> lock(memo_lifetime_->mutex);
+            memo_lifetime_->alive = false;
+        }
         for (auto& engine_context: engines_)
         {
             engine_context->StopExecutionLoop();
@@ -66,30 +159,388 @@ public:
         }
     }
 
+    // Whether every engine ran the bootstrap scripts during construction. A pool that isn't ready still hands out
+    // engines, but their contexts may lack what the failed scripts would have defined.
+    [[nodiscard]] bool IsReady() const
+    {
+        return ready_.load(std::memory_order_acquire);
+    }
+
+    // Zero-initialized SharedArrayBuffer visible as global `name` in every engine after its next reset; fill
+    // it through the returned view before handing out engines that read it.
+    V8BufferView RegisterSharedBuffer(const std::string &name, size_t byte_length)
+    {
+        return shared_buffers_->Register(name, byte_length);
+    }
+
+    [[nodiscard]] V8BufferView GetSharedBuffer(const std::string &name) const
+    {
+        return shared_buffers_->Get(name);
+    }
+
+    void RemoveSharedBuffer(const std::string &name)
+    {
+        shared_buffers_->Remove(name);
+    }
+
     V8EngineGuard getEngine()
+    {
+        return {acquireEngine(), this};
+    }
+
+    // The engine hosting key's persistent context, with that context current and not reset: globals set by
+    // earlier requests of the session are still there. Waits while the hosting engine is busy, since a
+    // session never moves between engines; a new session goes to the idle engine hosting the fewest.
+    V8SessionGuard getSession(const std::string &key)
     {
         std::unique_lock<std::mutex> lock(mutex_);
-        cv_.wait(lock, [this] { return !available_engines_.empty(); });
+        std::shared_ptr<V8EngineContext> engine;
+        for (;;)
+        {
+            const auto it = sessions_.find(key);
+            if (it != sessions_.end())
+            {
+                if (!it->second.busy && takeAvailable(it->second.engine))
+                {
+                    engine = it->second.engine;
+                    it->second.busy = true;
+                    session_lru_.splice(session_lru_.begin(), session_lru_, it->second.lru);
+                    ++session_metrics_.hits;
+                    break;
+                }
+            } else if (!available_engines_.empty())
+            {
+                const auto least_loaded = std::min_element(
+                    available_engines_.begin(), available_engines_.end(),
+                    [this](const auto &a, const auto &b)
+                    {
+                        return sessions_per_engine_[a.get()] < sessions_per_engine_[b.get()];
+                    });
+                engine = *least_loaded;
+                available_engines_.erase(least_loaded);
+                session_lru_.push_front(key);
+                sessions_.emplace(key, SessionEntry{engine, session_lru_.begin(), true});
+                ++sessions_per_engine_[engine.get()];
+                ++session_metrics_.misses;
+                break;
+            }
+            cv_.wait(lock);
+        }
+        evictSessions(lock);
+        const V8SessionOptions options = session_options_;
+        lock.unlock();
 
-        auto engine = available_engines_.front();
-        engine->Reset();
-        available_engines_.pop();
-        //v8::Isolate::Scope isolate_scope(engine->GetIsolate());
+        try
+        {
+            if (!engine->ActivateSession(key) && options.load_snapshot && !options.restore_function.empty())
+            {
+                if (std::optional<V8SerializedValue> state = options.load_snapshot(key))
+                {
+                    const std::vector<std::shared_ptr<JSValueWrapper> > args{engine->Deserialize(*state)};
+                    engine->CallJSFunction(options.restore_function, args);
+                }
+            }
+        } catch (...)
+        {
+            returnSession(key, engine);
+            throw;
+        }
+        return {engine, this, key};
+    }
+
+    // Memoized view of a global function of the bootstrap scripts, caching into the pool's shared cache. Misses
+    // run on any engine of the pool; hits never leave the calling thread. A zero ttl never expires. The function
+    // may outlive the manager: it keeps serving cached results, and a miss then throws std::runtime_error.
+    template<typename Out = nlohmann::json, typename... Args>
+    std::shared_ptr<V8MemoizedFunction<Out, Args...> > Memoize(const std::string &function_name,
+                                                               std::chrono::milliseconds ttl = std::chrono::minutes(5))
+    {
+        return std::make_shared<V8MemoizedFunction<Out, Args...> >(
+            memo_cache_, [this, lifetime = memo_lifetime_, function_name](const Args &... args)
+            {
+                std::shared_lock<std::shared_mutex> lock(lifetime->mutex);
+                if (!lifetime->alive)
+                {
+                    throw std::runtime_error("Memoized function " + function_name +
+                                             " called after its engine pool was destroyed");
+                }
+                V8EngineGuard engine = getEngine();
+                return engine.get()->template CallJSFunctionTyped<Out, Args...>(function_name, args...);
+            }, ttl);
+    }
+
+    [[nodiscard]] V8MemoCache &GetMemoCache()
+    {
+        return *memo_cache_;
+    }
+
+    // New bootstrap scripts for every engine, taking effect as each is next taken from the pool; session
+    // contexts keep the scripts they were created with. Memoized results computed by the old scripts are
+    // invalidated.
+    void ReloadBootstrap(V8EngineBootstrap bootstrap)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            bootstrap_ = std::make_shared<const V8EngineBootstrap>(std::move(bootstrap));
+            for (const auto &engine: engines_)
+            {
+                engine->SetBootstrap(bootstrap_);
+            }
+        }
+        memo_cache_->InvalidateAll();
+    }
 
-        return {engine, this};
+    void SetSessionOptions(V8SessionOptions options)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        session_options_ = std::move(options);
+    }
+
+    [[nodiscard]] V8SessionMetrics GetSessionMetrics()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        V8SessionMetrics metrics = session_metrics_;
+        metrics.live_sessions = sessions_.size();
+        return metrics;
+    }
+
+    // CallJSFunctionBatch over contiguous slices of inputs on up to max_engines engines in parallel, with the
+    // results in input order. Engines are reset when taken from the pool, so the function must come from the
+    // bootstrap scripts. Only the first engine is waited for; the others are used only if they are idle.
+    template<typename Out = nlohmann::json, typename In>
+    std::vector<Out> CallJSFunctionBatch(const std::string &function_name, std::span<const In> inputs,
+                                         size_t max_engines = 1)
+    {
+        std::vector<std::shared_ptr<V8EngineContext> > engines{acquireEngine()};
+        const size_t wanted = std::min(max_engines, std::max<size_t>(inputs.size(), 1));
+        while (engines.size() < wanted)
+        {
+            auto engine = tryAcquireEngine();
+            if (!engine)
+            {
+                break;
+            }
+            engines.push_back(std::move(engine));
+        }
+
+        const size_t slice = (inputs.size() + engines.size() - 1) / engines.size();
+        std::vector<std::future<std::vector<Out> > > parts;
+        for (size_t i = 0; i < engines.size(); ++i)
+        {
+            const size_t begin = std::min(inputs.size(), i * slice);
+            parts.push_back(engines[i]->CallJSFunctionBatchAsync<Out, In>(
+                function_name, inputs.subspan(begin, std::min(slice, inputs.size() - begin))));
+        }
+
+        // Every part is waited for before its engine goes back to the pool, even after a failure
+        std::vector<Out> results;
+        results.reserve(inputs.size());
+        std::exception_ptr failure;
+        for (auto &part: parts)
+        {
+            try
+            {
+                std::vector<Out> part_results = part.get();
+                std::move(part_results.begin(), part_results.end(), std::back_inserter(results));
+            } catch (...)
+            {
+                if (!failure)
+                {
+                    failure = std::current_exception();
+                }
+            }
+        }
+        for (const auto &engine: engines)
+        {
+            returnEngine(engine);
+        }
+        if (failure)
+        {
+            std::rethrow_exception(failure);
+        }
+        return results;
+    }
+
+    template<typename Out = nlohmann::json, typename In>
+    std::vector<Out> CallJSFunctionBatch(const std::string &function_name, const std::vector<In> &inputs,
+                                         size_t max_engines = 1)
+    {
+        return CallJSFunctionBatch<Out, In>(function_name, std::span<const In>(inputs), max_engines);
+    }
+
+    // Maps every partition with map_source, a JS function expression (partition, index) => partial, on every
+    // engine that is idle, and folds the partials in partition order with reduce_source, (accumulator, partial,
+    // index) => accumulator, seeded with the first partial. Both run in freshly reset contexts, so they may use
+    // the bootstrap scripts. Failures and cancellation are reported in the result, never thrown; partitions
+    // must stay alive until the call returns.
+    template<typename Out = nlohmann::json, typename In>
+    V8MapReduceResult<Out> MapReduce(const std::string &map_source, const std::string &reduce_source,
+                                     std::span<const In> partitions,
+                                     std::shared_ptr<const V8CancellationToken> cancel = nullptr)
+    {
+        std::vector<std::shared_ptr<V8EngineContext> > engines{acquireEngine()};
+        while (engines.size() < partitions.size())
+        {
+            auto engine = tryAcquireEngine();
+            if (!engine)
+            {
+                break;
+            }
+            engines.push_back(std::move(engine));
+        }
+        auto job = std::make_shared<V8MapReduceJob<Out, In> >(engines, map_source, reduce_source, partitions,
+                                                              std::move(cancel));
+        V8MapReduceResult<Out> result = job->Run();
+        for (const auto &engine: engines)
+        {
+            returnEngine(engine);
+        }
+        return result;
+    }
+
+    template<typename Out = nlohmann::json, typename In>
+    V8MapReduceResult<Out> MapReduce(const std::string &map_source, const std::string &reduce_source,
+                                     const std::vector<In> &partitions,
+                                     std::shared_ptr<const V8CancellationToken> cancel = nullptr)
+    {
+        return MapReduce<Out, In>(map_source, reduce_source, std::span<const In>(partitions), std::move(cancel));
     }
 
 private:
     V8PlatformContext platform_context_;
     std::vector<std::shared_ptr<V8EngineContext>> engines_;
-    std::queue<std::shared_ptr<V8EngineContext>> available_engines_;
+    std::deque<std::shared_ptr<V8EngineContext>> available_engines_;
     std::mutex mutex_;
     std::condition_variable cv_;
+    std::shared_ptr<const V8EngineBootstrap> bootstrap_;
+    std::shared_ptr<V8SharedBufferRegistry> shared_buffers_;
+    std::shared_ptr<V8MemoCache> memo_cache_ = std::make_shared<V8MemoCache>();
+
+    // Shared with memoized functions, which reach the pool through a raw pointer only while alive is set.
+    struct MemoLifetime
+    {
+        std::shared_mutex mutex;
+        bool alive = true;
+    };
+
+    std::shared_ptr<MemoLifetime> memo_lifetime_ = std::make_shared<MemoLifetime>();
+    std::atomic<bool> ready_{false};
+
+    struct SessionEntry
+    {
+        std::shared_ptr<V8EngineContext> engine;
+        std::list<std::string>::iterator lru;
+        // Held by a guard or being evicted
+        bool busy = false;
+    };
+
+    std::unordered_map<std::string, SessionEntry> sessions_;
+    // Most recently used first
+    std::list<std::string> session_lru_;
+    std::unordered_map<const V8EngineContext *, size_t> sessions_per_engine_;
+    V8SessionOptions session_options_;
+    V8SessionMetrics session_metrics_;
+
+    std::shared_ptr<V8EngineContext> acquireEngine()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !available_engines_.empty(); });
+
+        auto engine = available_engines_.front();
+        engine->Reset();
+        available_engines_.pop_front();
+        return engine;
+    }
+
+    std::shared_ptr<V8EngineContext> tryAcquireEngine()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (available_engines_.empty())
+        {
+            return nullptr;
+        }
+        auto engine = available_engines_.front();
+        engine->Reset();
+        available_engines_.pop_front();
+        return engine;
+    }
 
     void returnEngine(const std::shared_ptr<V8EngineContext>& engine)
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        available_engines_.push(engine);
-        cv_.notify_one();
+        available_engines_.push_back(engine);
+        // Session requests wait for one particular engine, so every waiter has to look
+        cv_.notify_all();
+    }
+
+    void returnSession(const std::string &key, const std::shared_ptr<V8EngineContext>& engine)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessions_.at(key).busy = false;
+        available_engines_.push_back(engine);
+        cv_.notify_all();
+    }
+
+    // Removes engine from the idle ones if it is there.
+    bool takeAvailable(const std::shared_ptr<V8EngineContext>& engine)
+    {
+        const auto it = std::find(available_engines_.begin(), available_engines_.end(), engine);
+        if (it == available_engines_.end())
+        {
+            return false;
+        }
+        available_engines_.erase(it);
+        return true;
+    }
+
+    // Evicts least recently used sessions while over capacity. Only sessions on idle engines qualify, so a
+    // request never waits for another one; the pool stays over capacity until such a session turns up.
+    void evictSessions(std::unique_lock<std::mutex> &lock)
+    {
+        while (sessions_.size() > session_options_.capacity)
+        {
+            auto victim = sessions_.end();
+            for (auto it = session_lru_.rbegin(); it != session_lru_.rend(); ++it)
+            {
+                const auto candidate = sessions_.find(*it);
+                if (!candidate->second.busy && takeAvailable(candidate->second.engine))
+                {
+                    victim = candidate;
+                    break;
+                }
+            }
+            if (victim == sessions_.end())
+            {
+                return;
+            }
+            // Stays registered while its state is saved, so a request for it waits instead of recreating it
+            victim->second.busy = true;
+            const std::string key = victim->first;
+            const std::shared_ptr<V8EngineContext> engine = victim->second.engine;
+            const V8SessionOptions options = session_options_;
+            lock.unlock();
+
+            if (options.on_evict && !options.snapshot_expression.empty())
+            {
+                try
+                {
+                    engine->ActivateSession(key);
+                    options.on_evict(key, engine->CreateJSValue(options.snapshot_expression)->Serialize());
+                } catch (const std::exception &e)
+                {
+                    std::cerr << "Failed to snapshot session " << key << ": " << e.what() << std::endl;
+                }
+            }
+            engine->DropSession(key);
+
+            lock.lock();
+            const auto evicted = sessions_.find(key);
+            session_lru_.erase(evicted->second.lru);
+            sessions_.erase(evicted);
+            --sessions_per_engine_[engine.get()];
+            ++session_metrics_.evictions;
+            available_engines_.push_back(engine);
+            cv_.notify_all();
+        }
     }
 };
@@ -0,0 +1,139 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+// Exposes caller-owned one-byte text to V8 without copying it into the heap.
+// The shared_ptr keeps the buffer (a std::string, a memory-mapped file, ...) alive until V8 disposes the string.
+class V8ExternalOneByteString final : public v8::String::ExternalOneByteStringResource
+{
+public:
+    // Below this size a heap copy is cheaper than the external resource bookkeeping.
+    static constexpr size_t kMinExternalLength = 1024;
+
+    V8ExternalOneByteString(std::shared_ptr<const char> data, size_t length)
+        : data_(std::move(data)), length_(length)
+    {
+    }
+
+    [[nodiscard]] const char *data() const override { return data_.get(); }
+    [[nodiscard]] size_t length() const override { return length_; }
+
+    static bool IsAscii(const char *data, size_t length)
+    {
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            if (word & 0x8080808080808080ULL)
+            {
+                return false;
+            }
+        }
+        for (; i < length; ++i)
+        {
+            if (static_cast<unsigned char>(data[i]) & 0x80)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Latin-1 is V8's one-byte encoding, so any Latin-1 text can stay external.
+    static v8::MaybeLocal<v8::String> NewFromLatin1(v8::Isolate *isolate, std::shared_ptr<const char> data,
+                                                    size_t length)
+    {
+        if (length >= kMinExternalLength)
+        {
+            return NewExternal(isolate, std::move(data), length);
+        }
+        return v8::String::NewFromOneByte(isolate, reinterpret_cast<const uint8_t *>(data.get()),
+                                          v8::NewStringType::kNormal, static_cast<int>(length));
+    }
+
+    // UTF-8 text is byte-identical to Latin-1 only when it is pure ASCII, so anything else takes the transcoding copy.
+    static v8::MaybeLocal<v8::String> NewFromUtf8(v8::Isolate *isolate, std::shared_ptr<const char> data, size_t length)
+    {
+        if (length >= kMinExternalLength && IsAscii(data.get(), length))
+        {
+            return NewExternal(isolate, std::move(data), length);
+        }
+        return v8::String::NewFromUtf8(isolate, data.get(), v8::NewStringType::kNormal, static_cast<int>(length));
+    }
+
+private:
+    std::shared_ptr<const char> data_;
+    size_t length_;
+
+    // V8 owns the resource only once it returns a string; past String::kMaxLength it returns none and the
+    // resource is still ours to free.
+    static v8::MaybeLocal<v8::String> NewExternal(v8::Isolate *isolate, std::shared_ptr<const char> data,
+                                                  size_t length)
+    {
+        auto resource = std::make_unique<V8ExternalOneByteString>(std::move(data), length);
+        v8::Local<v8::String> string;
+        if (!v8::String::NewExternalOneByte(isolate, resource.get()).ToLocal(&string))
+        {
+            return {};
+        }
+        resource.release();
+        return string;
+    }
+};
+
+// UTF-16 text, V8's two-byte encoding, exposed without copying.
+class V8ExternalTwoByteString final : public v8::String::ExternalStringResource
+{
+public:
+    V8ExternalTwoByteString(std::shared_ptr<const char16_t> data, size_t length)
+        : data_(std::move(data)), length_(length)
+    {
+    }
+
+    [[nodiscard]] const uint16_t *data() const override { return reinterpret_cast<const uint16_t *>(data_.get()); }
+    [[nodiscard]] size_t length() const override { return length_; }
+
+    static v8::MaybeLocal<v8::String> New(v8::Isolate *isolate, std::shared_ptr<const char16_t> data, size_t length)
+    {
+        if (length >= V8ExternalOneByteString::kMinExternalLength)
+        {
+            return NewExternal(isolate, std::move(data), length);
+        }
+        return v8::String::NewFromTwoByte(isolate, reinterpret_cast<const uint16_t *>(data.get()),
+                                          v8::NewStringType::kNormal, static_cast<int>(length));
+    }
+
+private:
+    std::shared_ptr<const char16_t> data_;
+    size_t length_;
+
+    // Same ownership rule as V8ExternalOneByteString::NewExternal.
+    static v8::MaybeLocal<v8::String> NewExternal(v8::Isolate *isolate, std::shared_ptr<const char16_t> data,
+                                                  size_t length)
+    {
+        auto resource = std::make_unique<V8ExternalTwoByteString>(std::move(data), length);
+        v8::Local<v8::String> string;
+        if (!v8::String::NewExternalTwoByte(isolate, resource.get()).ToLocal(&string))
+        {
+            return {};
+        }
+        resource.release();
+        return string;
+    }
+};
+
+// UTF-8 text of a JS string, read without a copy when V8 already holds it as ASCII outside the JS heap. When
+// owner is set it keeps text alive; otherwise text points into V8's string, valid while the JSValueWrapper it
+// was read from is alive.
+struct V8StringView
+{
+    std::string_view text;
+    std::shared_ptr<const void> owner;
+};
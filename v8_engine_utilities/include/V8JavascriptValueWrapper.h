@@ -3,7 +3,22 @@
 //
 #pragma once
 #include "AsyncExecutor.h"
+#include "V8ValueSlotTable.h"
+#include "V8SerializedValue.h"
+#include "V8BufferView.h"
+#include "V8TypeConversion.h"
+#include "V8JsonConversion.h"
+#include "V8BinaryFormats.h"
+#include "V8KeyCache.h"
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <array>
 #include <future>
+#include <functional>
+#include <ostream>
+#include <string_view>
+#include <tuple>
 #include <v8.h>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
@@ -23,28 +38,35 @@ public:
         Function
     };
 
-    JSValueWrapper(v8::Isolate *isolate, const std::shared_ptr<v8::Global<v8::Context> > &globalContext,
-                   v8::Local<v8::Value> value, std::shared_ptr<AsyncExecutor> async_executor)
-        : isolate_(isolate), global_context_(globalContext), persistent_(isolate, value), async_executor_(std::move(async_executor))
+    // Constructed on the engine thread. Undefined, null, booleans and numbers are kept inline; every other
+    // value occupies a slot in the engine's handle table.
+    JSValueWrapper(v8::Isolate *isolate, const v8::Global<v8::Context> *globalContext,
+                   v8::Local<v8::Value> value, std::shared_ptr<AsyncExecutor> async_executor,
+                   V8ValueSlotTable *value_slots)
+        : async_executor_(std::move(async_executor)), value_slots_(value_slots), isolate_(isolate),
+          global_context_(globalContext)
     {
         type_ = GetValueType(value);
+        if (value->IsNumber())
+        {
+            inline_value_ = value.As<v8::Number>()->Value();
+        } else if (value->IsBoolean())
+        {
+            inline_value_ = value->IsTrue() ? 1.0 : 0.0;
+        } else if (!value->IsUndefined() && !value->IsNull())
+        {
+            slot_ = value_slots_->Allocate(isolate_, value);
+        }
     }
 
     ~JSValueWrapper()
     {
-        std::promise<void> promise;
-        std::future<void> future = promise.get_future();
-
-        async_executor_->ExecuteAsync([this, &promise]()
+        // Never waits on the engine, so wrappers can also be dropped on the engine thread itself.
+        // The slot is reset when the engine starts its next task.
+        if (slot_ != V8ValueSlotTable::kInvalidSlot)
         {
-            if (!persistent_.IsEmpty()) {
-                persistent_.Reset();
-            }
-            promise.set_value();
-        });
-        future.get();
-        async_executor_.reset();
-
+            value_slots_->Release(slot_);
+        }
     }
 
     [[nodiscard]] Type GetType() const { return type_; }
@@ -60,92 +82,418 @@ public:
             v8::HandleScope handle_scope(isolate_);
             v8::Local<v8::Context> context = global_context_->Get(isolate_);
             v8::Context::Scope context_scope(context);
-            v8::Local<v8::Value> value = persistent_.Get(isolate_);
+            v8::Local<v8::Value> value = GetV8ValueInternal();
             promise.set_value(ConvertToNative<T>(value, context));
         });
         return future.get();
     }
 
+    // A typed array or an array of numbers as a vector. Typed arrays are copied out of their backing store and
+    // number arrays are read in a single Array::Iterate pass; other arrays convert element by element.
+    template<typename T>
+    std::vector<T> ToVector() const
+    {
+        static_assert(IsV8NumericElement<T>::value, "ToVector needs an arithmetic element type");
+        return Get<std::vector<T> >();
+    }
+
     template<typename T>
     T Get(std::string key) const
+    {
+        return GetProperty<T>([this, key = std::move(key)]()
+        {
+            return V8KeyCache::Internalize(isolate_, key);
+        });
+    }
+
+    // Reuses key's cached internalized name; create the key once, outside the loop.
+    template<typename T>
+    T Get(const PropertyKey &key) const
+    {
+        return GetProperty<T>([this, &key]()
+        {
+            return V8KeyCache::Key(isolate_, key);
+        });
+    }
+
+    template<typename T>
+    void Set(const std::string &key, const T &value)
+    {
+        SetProperty(key, value, [this, &key]()
+        {
+            return V8KeyCache::Internalize(isolate_, key);
+        });
+    }
+
+    template<typename T>
+    void Set(const PropertyKey &key, const T &value)
+    {
+        SetProperty(key.Name(), value, [this, &key]()
+        {
+            return V8KeyCache::Key(isolate_, key);
+        });
+    }
+
+    // Reads several properties in one engine task instead of one round trip per key. Paths may be dotted
+    // ("data.nested.a", "items.0"): auto [name, a] = value->GetMany<std::string, int>({"name", "data.nested.a"});
+    template<typename... Ts>
+    std::tuple<Ts...> GetMany(const std::array<std::string, sizeof...(Ts)> &paths) const
     {
         if (type_ != Type::Object && type_ != Type::Array)
         {
             throw std::runtime_error("Cannot get property on non-object value");
         }
-        std::promise<T> promise;
-        std::future<T> future = promise.get_future();
+        std::promise<std::tuple<Ts...> > promise;
+        std::future<std::tuple<Ts...> > future = promise.get_future();
 
-        async_executor_->ExecuteAsync([this, &promise, key]()
+        async_executor_->ExecuteAsync([this, &promise, &paths]()
         {
             v8::HandleScope handle_scope(isolate_);
             v8::Local<v8::Context> context = global_context_->Get(isolate_);
             v8::Context::Scope context_scope(context);
-            v8::Local<v8::Object> obj = persistent_.Get(isolate_).As<v8::Object>();
-            v8::Local<v8::String> v8_key = v8::String::NewFromUtf8(isolate_, key.c_str()).ToLocalChecked();
-            v8::MaybeLocal<v8::Value> value = obj->Get(context, v8_key);
-            if (value.IsEmpty())
+            const v8::Local<v8::Value> value = GetV8ValueInternal();
+            try
             {
-                throw std::runtime_error("Cannot find property on object");
+                promise.set_value(GetManyFrom<Ts...>(context, value, paths, std::index_sequence_for<Ts...>{}));
+            } catch (...)
+            {
+                promise.set_exception(std::current_exception());
             }
-            promise.set_value(ConvertToNative<T>(value.ToLocalChecked(), context));
         });
         return future.get();
     }
 
-    template<typename T>
-    void Set(const std::string &key, const T &value)
+    // Writes several properties in one engine task: value->SetMany({"x", "data.label"}, 10, std::string("ten"));
+    template<typename... Ts>
+    void SetMany(const std::array<std::string, sizeof...(Ts)> &paths, const Ts &... values)
     {
         if (type_ != Type::Object && type_ != Type::Array)
         {
             throw std::runtime_error("Cannot set property on non-object value");
         }
-        std::promise<bool> promise;
-        std::future<bool> future = promise.get_future();
+        std::promise<void> promise;
+        std::future<void> future = promise.get_future();
 
-        async_executor_->ExecuteAsync([this, &promise, key, value]()
+        async_executor_->ExecuteAsync([this, &promise, &paths, &values...]()
         {
             v8::HandleScope handle_scope(isolate_);
             v8::Local<v8::Context> context = global_context_->Get(isolate_);
             v8::Context::Scope context_scope(context);
-            v8::Local<v8::Object> obj = persistent_.Get(isolate_).As<v8::Object>();
-            v8::Local<v8::String> v8_key = v8::String::NewFromUtf8(isolate_, key.c_str()).ToLocalChecked();
-            v8::Local<v8::Value> v8_value = ConvertToV8(value);
-            if (obj->Set(context, v8_key, v8_value).IsNothing())
+            const v8::Local<v8::Value> value = GetV8ValueInternal();
+            try
+            {
+                const std::array<v8::Local<v8::Value>, sizeof...(Ts)> v8_values{ConvertToV8(values)...};
+                for (size_t i = 0; i < paths.size(); ++i)
+                {
+                    SetPath(context, value, paths[i], v8_values[i]);
+                }
+                promise.set_value();
+            } catch (...)
             {
-                throw std::runtime_error("Failed to set property: " + key);
+                promise.set_exception(std::current_exception());
             }
-            promise.set_value(true);
         });
         future.get();
     }
 
     [[nodiscard]] v8::Local<v8::Value> GetV8ValueInternal() const
     {
-        return persistent_.Get(isolate_);
+        if (slot_ != V8ValueSlotTable::kInvalidSlot)
+        {
+            return value_slots_->Get(isolate_, slot_);
+        }
+        switch (type_)
+        {
+            case Type::Null:
+                return v8::Null(isolate_);
+            case Type::Boolean:
+                return v8::Boolean::New(isolate_, inline_value_ != 0.0);
+            case Type::Number:
+                return v8::Number::New(isolate_, inline_value_);
+            default:
+                return v8::Undefined(isolate_);
+        }
     }
 
-    [[nodiscard]] nlohmann::json ToJson() const
+    // Reads a string without the Utf8Value allocation when V8 holds it as one-byte ASCII. A large one-byte
+    // string still on the JS heap is moved out of it on the first call (MakeExternal), so later calls are free;
+    // everything else is transcoded into an owned copy. See V8StringView for how long text stays valid.
+    [[nodiscard]] V8StringView GetStringView() const
+    {
+        if (type_ != Type::String)
+        {
+            throw std::runtime_error("Value is not a string");
+        }
+        std::promise<V8StringView> promise;
+        std::future<V8StringView> future = promise.get_future();
+
+        async_executor_->ExecuteAsync([this, &promise]()
+        {
+            v8::HandleScope handle_scope(isolate_);
+            const v8::Local<v8::String> string = GetV8ValueInternal().As<v8::String>();
+            V8StringView view;
+            if (string->IsExternalOneByte())
+            {
+                const auto *resource = string->GetExternalOneByteStringResource();
+                if (V8ExternalOneByteString::IsAscii(resource->data(), resource->length()))
+                {
+                    view.text = std::string_view(resource->data(), resource->length());
+                    promise.set_value(std::move(view));
+                    return;
+                }
+            } else if (string->IsOneByte() && static_cast<size_t>(string->Length()) >=
+                       V8ExternalOneByteString::kMinExternalLength)
+            {
+                const size_t length = string->Length();
+                char *buffer = new char[length];
+                std::shared_ptr<const char> copy(buffer, [](const char *data) { delete[] data; });
+                string->WriteOneByte(isolate_, reinterpret_cast<uint8_t *>(buffer), 0, static_cast<int>(length),
+                                     v8::String::NO_NULL_TERMINATION);
+                if (V8ExternalOneByteString::IsAscii(copy.get(), length))
+                {
+                    // The copy is valid UTF-8 either way; externalizing just lets later calls skip it
+                    if (string->CanMakeExternal(v8::String::Encoding::ONE_BYTE_ENCODING))
+                    {
+                        auto *resource = new V8ExternalOneByteString(copy, length);
+                        if (!string->MakeExternal(resource))
+                        {
+                            delete resource;
+                        }
+                    }
+                    view.text = std::string_view(copy.get(), length);
+                    view.owner = std::move(copy);
+                    promise.set_value(std::move(view));
+                    return;
+                }
+            }
+            auto owned = std::make_shared<std::string>(
+                V8Converter<std::string>::FromV8(isolate_, v8::Local<v8::Context>(), string));
+            view.text = *owned;
+            view.owner = std::move(owned);
+            promise.set_value(std::move(view));
+        });
+        return future.get();
+    }
+
+    // Walks the value iteratively, so neither deep nesting nor cycles can exhaust the engine thread's stack.
+    // Dates, Maps, Sets, BigInts and typed arrays convert as described in V8ValueWalker. Throws
+    // std::runtime_error on a cycle (unless options ask for a placeholder), an exceeded limit or a throwing getter.
+    [[nodiscard]] nlohmann::json ToJson(const V8WalkOptions &options = {}) const
     {
         std::promise<nlohmann::json> promise;
         std::future<nlohmann::json> future = promise.get_future();
 
+        async_executor_->ExecuteAsync([this, &promise, &options]()
+        {
+            v8::HandleScope handle_scope(isolate_);
+            v8::Local<v8::Context> context = global_context_->Get(isolate_);
+            v8::Context::Scope context_scope(context);
+            try
+            {
+                V8JsonSink sink;
+                V8ValueWalker<V8JsonSink>(isolate_, context, sink, options).Walk(GetV8ValueInternal());
+                promise.set_value(std::move(sink.Result()));
+            } catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        });
+        return future.get();
+    }
+
+    // Writes the value as JSON text to out in chunks of about chunk_size bytes, straight from the V8 heap and
+    // without building a document or a full string. Same value mapping and failure modes as ToJson; on failure,
+    // whatever was written so far stays in the stream.
+    void ToJsonStream(std::ostream &out, const V8WalkOptions &options = {}, size_t chunk_size = 64 * 1024) const
+    {
+        ToJsonChunks([&out](std::string_view chunk)
+        {
+            out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        }, options, chunk_size);
+    }
+
+    // Same, handing each chunk to on_chunk. It runs on the engine thread while this call waits, and the view is
+    // only valid during the call. Buffered output stays within chunk_size and V8 handles grow with the nesting
+    // depth only, whatever the size of the value; long strings are read in slices. Typed arrays are still
+    // copied out one at a time.
+    void ToJsonChunks(const V8JsonTextWriter::ChunkCallback &on_chunk, const V8WalkOptions &options = {},
+                      size_t chunk_size = 64 * 1024) const
+    {
+        std::promise<void> promise;
+        std::future<void> future = promise.get_future();
+
+        async_executor_->ExecuteAsync([this, &promise, &on_chunk, &options, chunk_size]()
+        {
+            v8::HandleScope handle_scope(isolate_);
+            v8::Local<v8::Context> context = global_context_->Get(isolate_);
+            v8::Context::Scope context_scope(context);
+            try
+            {
+                V8JsonTextWriter writer(on_chunk, chunk_size);
+                V8ValueWalker<V8JsonTextWriter>(isolate_, context, writer, options).Walk(GetV8ValueInternal());
+                writer.Flush();
+                promise.set_value();
+            } catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        });
+        future.get();
+    }
+
+    // MessagePack written straight from the V8 heap, without building a JSON document first. Same value mapping
+    // and failure modes as ToJson.
+    [[nodiscard]] std::vector<uint8_t> ToMsgPack(const V8WalkOptions &options = {}) const
+    {
+        return WriteBinary<V8MsgPackWriter>(options);
+    }
+
+    [[nodiscard]] std::vector<uint8_t> ToCbor(const V8WalkOptions &options = {}) const
+    {
+        return WriteBinary<V8CborWriter>(options);
+    }
+
+    // Serializes with V8's own JSON.stringify straight into a string, skipping the nlohmann DOM. Follows
+    // JSON.stringify semantics, unlike ToJson: toJSON is honoured, undefined and functions are dropped from
+    // objects, Maps and Sets become {} and BigInts throw. A value with no JSON form at all (undefined, a function)
+    // gives "null", as ToJson does, instead of JSON.stringify's non-JSON "undefined".
+    [[nodiscard]] std::string ToJsonString() const
+    {
+        std::string result;
+        ToJsonString(result);
+        return result;
+    }
+
+    // Overwrites out, reusing its capacity across calls.
+    void ToJsonString(std::string &out) const
+    {
+        std::promise<void> promise;
+        std::future<void> future = promise.get_future();
+
+        async_executor_->ExecuteAsync([this, &promise, &out]()
+        {
+            v8::HandleScope handle_scope(isolate_);
+            v8::Local<v8::Context> context = global_context_->Get(isolate_);
+            v8::Context::Scope context_scope(context);
+            const v8::TryCatch try_catch(isolate_);
+            v8::Local<v8::String> json_string;
+            if (!v8::JSON::Stringify(context, GetV8ValueInternal()).ToLocal(&json_string))
+            {
+                v8::String::Utf8Value error(isolate_, try_catch.Exception());
+                promise.set_exception(std::make_exception_ptr(
+                    std::runtime_error(std::string("Failed to stringify value: ") + (*error ? *error : ""))));
+                return;
+            }
+            const int length = json_string->Utf8Length(isolate_);
+            out.resize(length);
+            json_string->WriteUtf8(isolate_, out.data(), length, nullptr,
+                                   v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+            // Any JSON text of a string is quoted, so this can only be the undefined result
+            if (out == "undefined")
+            {
+                out.assign("null");
+            }
+            promise.set_value();
+        });
+        future.get();
+    }
+
+    // Zero-copy access to the memory of an ArrayBuffer, SharedArrayBuffer or ArrayBufferView (typed array,
+    // DataView); views are narrowed to their own byte range.
+    [[nodiscard]] V8BufferView GetBackingStore() const
+    {
+        std::promise<V8BufferView> promise;
+        std::future<V8BufferView> future = promise.get_future();
+
         async_executor_->ExecuteAsync([this, &promise]()
+        {
+            v8::HandleScope handle_scope(isolate_);
+            const v8::Local<v8::Value> value = GetV8ValueInternal();
+            V8BufferView view;
+            size_t offset = 0;
+            size_t length = 0;
+            if (value->IsArrayBuffer())
+            {
+                view.backing_store = value.As<v8::ArrayBuffer>()->GetBackingStore();
+                length = value.As<v8::ArrayBuffer>()->ByteLength();
+            } else if (value->IsSharedArrayBuffer())
+            {
+                view.backing_store = value.As<v8::SharedArrayBuffer>()->GetBackingStore();
+                length = value.As<v8::SharedArrayBuffer>()->ByteLength();
+            } else if (value->IsArrayBufferView())
+            {
+                // Buffer() moves small on-heap typed arrays off-heap, so the data no longer moves with the GC
+                const v8::Local<v8::ArrayBufferView> buffer_view = value.As<v8::ArrayBufferView>();
+                view.backing_store = buffer_view->Buffer()->GetBackingStore();
+                offset = buffer_view->ByteOffset();
+                length = buffer_view->ByteLength();
+            } else
+            {
+                promise.set_exception(std::make_exception_ptr(
+                    std::runtime_error("Value is not an ArrayBuffer, SharedArrayBuffer or ArrayBufferView")));
+                return;
+            }
+            auto *data = static_cast<std::byte *>(view.backing_store->Data());
+            view.bytes = data ? std::span<std::byte>(data + offset, length) : std::span<std::byte>();
+            promise.set_value(std::move(view));
+        });
+        return future.get();
+    }
+
+    // Structured-clone snapshot of the value, the way to hand it to another engine; a wrapper's handle is only
+    // valid inside the isolate that created it. With transfer_array_buffers, every ArrayBuffer reachable from
+    // the value is detached here and its memory moves to the receiving engine without being copied.
+    [[nodiscard]] V8SerializedValue Serialize(bool transfer_array_buffers = false) const
+    {
+        std::promise<V8SerializedValue> promise;
+        std::future<V8SerializedValue> future = promise.get_future();
+
+        async_executor_->ExecuteAsync([this, &promise, transfer_array_buffers]()
         {
             v8::HandleScope handle_scope(isolate_);
             v8::Local<v8::Context> context = global_context_->Get(isolate_);
             v8::Context::Scope context_scope(context);
-            v8::Local<v8::Value> value = persistent_.Get(isolate_);
-            promise.set_value(V8ToJson(value, context));
+            const v8::Local<v8::Value> value = GetV8ValueInternal();
+            const v8::TryCatch try_catch(isolate_);
+
+            std::vector<v8::Local<v8::ArrayBuffer> > transfers;
+            if (transfer_array_buffers)
+            {
+                CollectArrayBuffers(context, value, transfers);
+            }
+            std::optional<V8SerializedValue> serialized = V8SerializedValue::Write(isolate_, context, value, transfers);
+            if (!serialized)
+            {
+                v8::String::Utf8Value error(isolate_, try_catch.Exception());
+                promise.set_exception(std::make_exception_ptr(
+                    std::runtime_error(std::string("Failed to serialize value: ") + (*error ? *error : ""))));
+                return;
+            }
+            for (const auto &array_buffer: transfers)
+            {
+                // Buffers with a detach key (e.g. owned by WebAssembly memory) refuse to be detached
+                if (array_buffer->Detach(v8::Local<v8::Value>()).IsNothing())
+                {
+                    v8::String::Utf8Value error(isolate_, try_catch.Exception());
+                    promise.set_exception(std::make_exception_ptr(
+                        std::runtime_error(std::string("Failed to detach transferred ArrayBuffer: ") +
+                                           (*error ? *error : ""))));
+                    return;
+                }
+            }
+            promise.set_value(std::move(*serialized));
         });
         return future.get();
     }
 
 private:
     std::shared_ptr<AsyncExecutor> async_executor_;
+    // The slot table and context handle are owned by the engine, which async_executor_ keeps alive.
+    V8ValueSlotTable *value_slots_;
     v8::Isolate *isolate_;
-    std::shared_ptr<v8::Global<v8::Context> > global_context_;
-    v8::Global<v8::Value> persistent_;
+    const v8::Global<v8::Context> *global_context_;
+    uint32_t slot_ = V8ValueSlotTable::kInvalidSlot;
+    double inline_value_ = 0.0;
     Type type_;
 
     static Type GetValueType(v8::Local<v8::Value> value)
@@ -161,120 +509,233 @@ private:
         return Type::Undefined;
     }
 
-    template<typename T>
-    T ConvertToNative(v8::Local<v8::Value> value, v8::Local<v8::Context> &context) const
+    template<typename T, typename MakeKey>
+    T GetProperty(const MakeKey &make_key) const
     {
-        if constexpr (std::is_same_v<T, bool>)
-        {
-            return value->BooleanValue(isolate_);
-        } else if constexpr (std::is_integral_v<T>)
-        {
-            return value->IntegerValue(context).FromMaybe(0);
-        } else if constexpr (std::is_floating_point_v<T>)
-        {
-            return value->NumberValue(context).FromMaybe(0.0);
-        } else if constexpr (std::is_same_v<T, std::string>)
+        if (type_ != Type::Object && type_ != Type::Array)
         {
-            v8::String::Utf8Value utf8(isolate_, value);
-            return std::string(*utf8);
-        } else if constexpr (std::is_same_v<T, std::vector<T> >)
+            throw std::runtime_error("Cannot get property on non-object value");
+        }
+        std::promise<T> promise;
+        std::future<T> future = promise.get_future();
+
+        async_executor_->ExecuteAsync([this, &promise, &make_key]()
         {
-            std::vector<T> result;
-            if (value->IsArray())
+            v8::HandleScope handle_scope(isolate_);
+            v8::Local<v8::Context> context = global_context_->Get(isolate_);
+            v8::Context::Scope context_scope(context);
+            try
             {
-                v8::Local<v8::Array> array = value.As<v8::Array>();
-                result.reserve(array->Length());
-                for (uint32_t i = 0; i < array->Length(); ++i)
+                v8::Local<v8::Object> obj = GetV8ValueInternal().As<v8::Object>();
+                v8::Local<v8::String> v8_key = make_key();
+                v8::MaybeLocal<v8::Value> value = obj->Get(context, v8_key);
+                if (value.IsEmpty())
                 {
-                    v8::Local<v8::Value> element;
-                    if (array->Get(context, i).ToLocal(&element))
-                    {
-                        result.push_back(ConvertToNative<T>(element, context));
-                    }
+                    throw std::runtime_error("Cannot find property on object");
                 }
+                promise.set_value(ConvertToNative<T>(value.ToLocalChecked(), context));
+            } catch (...)
+            {
+                promise.set_exception(std::current_exception());
             }
-            return result;
-        } else
-        {
-            throw std::runtime_error("Unsupported type conversion");
-        }
+        });
+        return future.get();
     }
 
-    template<typename T>
-    v8::Local<v8::Value> ConvertToV8(const T &value) const
+    template<typename T, typename MakeKey>
+    void SetProperty(const std::string &key, const T &value, const MakeKey &make_key)
     {
-        if constexpr (std::is_same_v<T, bool>)
-        {
-            return v8::Boolean::New(isolate_, value);
-        } else if constexpr (std::is_integral_v<T>)
-        {
-            return v8::Integer::New(isolate_, value);
-        } else if constexpr (std::is_floating_point_v<T>)
-        {
-            return v8::Number::New(isolate_, value);
-        } else if constexpr (std::is_same_v<T, std::string>)
+        if (type_ != Type::Object && type_ != Type::Array)
         {
-            return v8::String::NewFromUtf8(isolate_, value.c_str()).ToLocalChecked();
-        } else if constexpr (std::is_same_v<T, std::vector<T> >)
+            throw std::runtime_error("Cannot set property on non-object value");
+        }
+        std::promise<bool> promise;
+        std::future<bool> future = promise.get_future();
+
+        async_executor_->ExecuteAsync([this, &promise, &key, &value, &make_key]()
         {
-            v8::Local<v8::Array> array = v8::Array::New(isolate_, value.size());
-            v8::Local<v8::Context> context = isolate_->GetCurrentContext();
-            for (size_t i = 0; i < value.size(); ++i)
+            v8::HandleScope handle_scope(isolate_);
+            v8::Local<v8::Context> context = global_context_->Get(isolate_);
+            v8::Context::Scope context_scope(context);
+            try
+            {
+                v8::Local<v8::Object> obj = GetV8ValueInternal().As<v8::Object>();
+                v8::Local<v8::String> v8_key = make_key();
+                v8::Local<v8::Value> v8_value = ConvertToV8(value);
+                if (obj->Set(context, v8_key, v8_value).IsNothing())
+                {
+                    throw std::runtime_error("Failed to set property: " + key);
+                }
+                promise.set_value(true);
+            } catch (...)
             {
-                array->Set(context, i, ConvertToV8(value[i])).Check();
+                promise.set_exception(std::current_exception());
             }
-            return array;
-        } else
-        {
-            throw std::runtime_error("Unsupported type conversion");
-        }
+        });
+        future.get();
     }
 
-    nlohmann::json V8ToJson(v8::Local<v8::Value> value, v8::Local<v8::Context> &context) const
+    template<typename Writer>
+    std::vector<uint8_t> WriteBinary(const V8WalkOptions &options) const
     {
-        if (value->IsNull())
-        {
-            return nullptr;
-        } else if (value->IsBoolean())
-        {
-            return value->BooleanValue(isolate_);
-        } else if (value->IsNumber())
-        {
-            return value->NumberValue(context).FromMaybe(0.0);
-        } else if (value->IsString())
+        std::promise<std::vector<uint8_t> > promise;
+        std::future<std::vector<uint8_t> > future = promise.get_future();
+
+        async_executor_->ExecuteAsync([this, &promise, &options]()
         {
-            v8::String::Utf8Value utf8_value(isolate_, value);
-            return std::string(*utf8_value);
-        } else if (value->IsArray())
+            v8::HandleScope handle_scope(isolate_);
+            v8::Local<v8::Context> context = global_context_->Get(isolate_);
+            v8::Context::Scope context_scope(context);
+            try
+            {
+                std::vector<uint8_t> out;
+                Writer writer(out);
+                V8ValueWalker<Writer>(isolate_, context, writer, options).Walk(GetV8ValueInternal());
+                promise.set_value(std::move(out));
+            } catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        });
+        return future.get();
+    }
+
+    // Finds every detachable ArrayBuffer reachable from value, each once, in discovery order.
+    void CollectArrayBuffers(v8::Local<v8::Context> &context, v8::Local<v8::Value> root,
+                             std::vector<v8::Local<v8::ArrayBuffer> > &array_buffers) const
+    {
+        std::unordered_multimap<int, v8::Local<v8::Object> > visited;
+        std::vector<v8::Local<v8::Value> > pending{root};
+        while (!pending.empty())
         {
-            v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(value);
-            nlohmann::json j_array = nlohmann::json::array();
-            for (uint32_t i = 0; i < array->Length(); ++i)
+            const v8::Local<v8::Value> value = pending.back();
+            pending.pop_back();
+            if (!value->IsObject())
             {
-                v8::MaybeLocal<v8::Value> maybe_element = array->Get(context, i);
-                if (!maybe_element.IsEmpty())
+                continue;
+            }
+            const v8::Local<v8::Object> object = value.As<v8::Object>();
+            const auto [first, last] = visited.equal_range(object->GetIdentityHash());
+            bool seen = false;
+            for (auto it = first; it != last && !seen; ++it)
+            {
+                seen = it->second->StrictEquals(object);
+            }
+            if (seen)
+            {
+                continue;
+            }
+            visited.emplace(object->GetIdentityHash(), object);
+
+            if (value->IsArrayBuffer())
+            {
+                if (value.As<v8::ArrayBuffer>()->IsDetachable())
                 {
-                    j_array.push_back(V8ToJson(maybe_element.ToLocalChecked(), context));
+                    array_buffers.push_back(value.As<v8::ArrayBuffer>());
                 }
+                continue;
             }
-            return j_array;
-        } else if (value->IsObject())
-        {
-            v8::Local<v8::Object> object = value.As<v8::Object>();
-            nlohmann::json j_object = nlohmann::json::object();
-            v8::Local<v8::Array> property_names = object->GetOwnPropertyNames(context).ToLocalChecked();
-            for (uint32_t i = 0; i < property_names->Length(); ++i)
+            if (value->IsArrayBufferView())
+            {
+                const v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+                if (view->HasBuffer())
+                {
+                    pending.push_back(view->Buffer());
+                }
+                continue;
+            }
+            v8::Local<v8::Array> entries;
+            if (value->IsMap())
+            {
+                entries = value.As<v8::Map>()->AsArray();
+            } else if (value->IsSet())
+            {
+                entries = value.As<v8::Set>()->AsArray();
+            } else if (!object->GetOwnPropertyNames(context).ToLocal(&entries))
+            {
+                continue;
+            }
+            const bool entries_are_keys = !value->IsMap() && !value->IsSet();
+            for (uint32_t i = 0; i < entries->Length(); ++i)
             {
-                v8::Local<v8::Value> key = property_names->Get(context, i).ToLocalChecked();
-                v8::MaybeLocal<v8::Value> maybe_value = object->Get(context, key);
-                if (!maybe_value.IsEmpty())
+                v8::Local<v8::Value> entry;
+                if (!entries->Get(context, i).ToLocal(&entry))
                 {
-                    v8::String::Utf8Value utf8_key(isolate_, key);
-                    j_object[std::string(*utf8_key)] = V8ToJson(maybe_value.ToLocalChecked(), context);
+                    continue;
                 }
+                if (entries_are_keys && !object->Get(context, entry).ToLocal(&entry))
+                {
+                    continue;
+                }
+                pending.push_back(entry);
             }
-            return j_object;
         }
-        return nullptr;
+    }
+
+    template<typename... Ts, size_t... I>
+    std::tuple<Ts...> GetManyFrom(v8::Local<v8::Context> &context, v8::Local<v8::Value> value,
+                                  const std::array<std::string, sizeof...(Ts)> &paths,
+                                  std::index_sequence<I...>) const
+    {
+        // Braced initialization keeps the lookups in path order
+        return std::tuple<Ts...>{ConvertToNative<Ts>(GetPath(context, value, paths[I]), context)...};
+    }
+
+    v8::Local<v8::Value> GetPath(v8::Local<v8::Context> &context, v8::Local<v8::Value> current,
+                                 std::string_view path) const
+    {
+        size_t start = 0;
+        while (true)
+        {
+            if (!current->IsObject())
+            {
+                throw std::runtime_error("Cannot resolve property path: " + std::string(path));
+            }
+            const size_t dot = path.find('.', start);
+            const std::string_view segment = path.substr(start, dot == std::string_view::npos
+                                                                    ? std::string_view::npos
+                                                                    : dot - start);
+            const v8::Local<v8::String> v8_key = V8KeyCache::Internalize(isolate_, segment);
+            if (!current.As<v8::Object>()->Get(context, v8_key).ToLocal(&current))
+            {
+                throw std::runtime_error("Cannot resolve property path: " + std::string(path));
+            }
+            if (dot == std::string_view::npos)
+            {
+                return current;
+            }
+            start = dot + 1;
+        }
+    }
+
+    void SetPath(v8::Local<v8::Context> &context, v8::Local<v8::Value> root, std::string_view path,
+                 v8::Local<v8::Value> v8_value) const
+    {
+        const size_t dot = path.rfind('.');
+        const v8::Local<v8::Value> parent = dot == std::string_view::npos
+                                                ? root
+                                                : GetPath(context, root, path.substr(0, dot));
+        const std::string_view key = dot == std::string_view::npos ? path : path.substr(dot + 1);
+        if (!parent->IsObject())
+        {
+            throw std::runtime_error("Failed to set property: " + std::string(path));
+        }
+        const v8::Local<v8::String> v8_key = V8KeyCache::Internalize(isolate_, key);
+        if (parent.As<v8::Object>()->Set(context, v8_key, v8_value).IsNothing())
+        {
+            throw std::runtime_error("Failed to set property: " + std::string(path));
+        }
+    }
+
+    template<typename T>
+    T ConvertToNative(v8::Local<v8::Value> value, v8::Local<v8::Context> &context) const
+    {
+        return V8Converter<T>::FromV8(isolate_, context, value);
+    }
+
+    template<typename T>
+    v8::Local<v8::Value> ConvertToV8(const T &value) const
+    {
+        return V8Converter<T>::ToV8(isolate_, isolate_->GetCurrentContext(), value);
     }
 };
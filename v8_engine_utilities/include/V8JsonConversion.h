@@ -0,0 +1,384 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "V8TypeConversion.h"
+#include "V8ValueWalker.h"
+
+// Builds an nlohmann::json document from V8ValueWalker events.
+class V8JsonSink
+{
+public:
+    nlohmann::json &Result()
+    {
+        return root_;
+    }
+
+    void Null() { Add(nullptr); }
+    void Boolean(bool value) { Add(value); }
+    void Integer(int64_t value) { Add(value); }
+    void Unsigned(uint64_t value) { Add(value); }
+    void Number(double value) { Add(value); }
+    void String(std::string_view value) { Add(std::string(value)); }
+
+    void BeginArray(size_t count)
+    {
+        nlohmann::json &array = Add(nlohmann::json::array());
+        array.get_ref<nlohmann::json::array_t &>().reserve(count);
+        open_.push_back(&array);
+    }
+
+    void EndArray() { open_.pop_back(); }
+
+    void BeginObject(size_t)
+    {
+        open_.push_back(&Add(nlohmann::json::object()));
+    }
+
+    void EndObject() { open_.pop_back(); }
+
+    void Key(std::string_view key) { key_.assign(key); }
+
+private:
+    nlohmann::json root_;
+    // Only the innermost open container is ever modified, so pointers to the outer ones stay valid.
+    std::vector<nlohmann::json *> open_;
+    std::string key_;
+
+    nlohmann::json &Add(nlohmann::json value)
+    {
+        if (open_.empty())
+        {
+            root_ = std::move(value);
+            return root_;
+        }
+        nlohmann::json &parent = *open_.back();
+        if (parent.is_array())
+        {
+            parent.push_back(std::move(value));
+            return parent.back();
+        }
+        return parent[key_] = std::move(value);
+    }
+};
+
+// Writes V8ValueWalker events as compact JSON text into a buffer of about chunk_size bytes, handing each full
+// buffer to a callback. Output memory stays bounded whatever the size of the value. Non-finite numbers are
+// written as null, as JSON.stringify does.
+class V8JsonTextWriter
+{
+public:
+    using ChunkCallback = std::function<void(std::string_view)>;
+
+    V8JsonTextWriter(ChunkCallback on_chunk, size_t chunk_size)
+        : on_chunk_(std::move(on_chunk)), chunk_size_(std::max<size_t>(chunk_size, 1))
+    {
+        buffer_.reserve(chunk_size_ + kMaxTokenLength);
+    }
+
+    void Null()
+    {
+        BeforeValue();
+        Append("null");
+    }
+
+    void Boolean(bool value)
+    {
+        BeforeValue();
+        Append(value ? "true" : "false");
+    }
+
+    void Integer(int64_t value)
+    {
+        BeforeValue();
+        AppendNumber(value);
+    }
+
+    void Unsigned(uint64_t value)
+    {
+        BeforeValue();
+        AppendNumber(value);
+    }
+
+    void Number(double value)
+    {
+        BeforeValue();
+        if (!std::isfinite(value))
+        {
+            Append("null");
+            return;
+        }
+        AppendNumber(value);
+    }
+
+    void String(std::string_view value)
+    {
+        BeforeValue();
+        AppendQuoted(value);
+    }
+
+    // Long strings arrive in slices from V8ValueWalker.
+    void BeginString()
+    {
+        BeforeValue();
+        Append("\"");
+    }
+
+    void StringPart(std::string_view part)
+    {
+        AppendEscaped(part);
+    }
+
+    void EndString()
+    {
+        Append("\"");
+    }
+
+    void BeginArray(size_t)
+    {
+        BeforeValue();
+        Append("[");
+        first_.push_back(true);
+    }
+
+    void EndArray()
+    {
+        first_.pop_back();
+        Append("]");
+    }
+
+    void BeginObject(size_t)
+    {
+        BeforeValue();
+        Append("{");
+        first_.push_back(true);
+    }
+
+    void Key(std::string_view key)
+    {
+        BeforeValue();
+        AppendQuoted(key);
+        Append(":");
+        after_key_ = true;
+    }
+
+    void EndObject()
+    {
+        first_.pop_back();
+        Append("}");
+    }
+
+    // Hands over whatever is still buffered; call once the walk has finished.
+    void Flush()
+    {
+        if (!buffer_.empty())
+        {
+            on_chunk_(buffer_);
+            buffer_.clear();
+        }
+    }
+
+private:
+    // Longest output of a single number.
+    static constexpr size_t kMaxTokenLength = 32;
+
+    ChunkCallback on_chunk_;
+    size_t chunk_size_;
+    std::string buffer_;
+    // Per open container: no element written yet.
+    std::vector<bool> first_;
+    bool after_key_ = false;
+
+    void BeforeValue()
+    {
+        if (after_key_)
+        {
+            after_key_ = false;
+            return;
+        }
+        if (!first_.empty())
+        {
+            if (!first_.back())
+            {
+                Append(",");
+            }
+            first_.back() = false;
+        }
+    }
+
+    void Append(std::string_view text)
+    {
+        buffer_.append(text);
+        if (buffer_.size() >= chunk_size_)
+        {
+            Flush();
+        }
+    }
+
+    template<typename T>
+    void AppendNumber(T value)
+    {
+        char digits[kMaxTokenLength];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        Append(std::string_view(digits, result.ptr - digits));
+    }
+
+    void AppendQuoted(std::string_view value)
+    {
+        Append("\"");
+        AppendEscaped(value);
+        Append("\"");
+    }
+
+    void AppendEscaped(std::string_view value)
+    {
+        size_t start = 0;
+        for (size_t i = 0; i < value.size(); ++i)
+        {
+            const auto c = static_cast<unsigned char>(value[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+            {
+                continue;
+            }
+            AppendLong(value.substr(start, i - start));
+            start = i + 1;
+            switch (c)
+            {
+                case '"':
+                    Append("\\\"");
+                    break;
+                case '\\':
+                    Append("\\\\");
+                    break;
+                case '\n':
+                    Append("\\n");
+                    break;
+                case '\r':
+                    Append("\\r");
+                    break;
+                case '\t':
+                    Append("\\t");
+                    break;
+                default:
+                {
+                    static constexpr char kHex[] = "0123456789abcdef";
+                    const char escape[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xf]};
+                    Append(std::string_view(escape, sizeof(escape)));
+                }
+            }
+        }
+        AppendLong(value.substr(start));
+    }
+
+    // Long strings are flushed in pieces, so a single huge string doesn't grow the buffer either.
+    void AppendLong(std::string_view text)
+    {
+        for (size_t start = 0; start < text.size(); start += chunk_size_)
+        {
+            Append(text.substr(start, chunk_size_));
+        }
+    }
+};
+
+// Builds V8 values directly from an nlohmann::json document, without going through the script compiler, and
+// reads any V8 value back through V8ValueWalker.
+template<>
+struct V8Converter<nlohmann::json>
+{
+    // Documents deeper than this are rejected instead of risking the engine thread's stack.
+    static constexpr int kMaxDepth = 1000;
+
+    static bool Is(v8::Local<v8::Value>) { return true; }
+
+    // Cycles read as "[Circular]"; a value that can't be read at all (too deep, a throwing getter) converts to
+    // null. Use JSValueWrapper::ToJson to get those failures as exceptions.
+    static nlohmann::json FromV8(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value)
+    {
+        V8WalkOptions options;
+        options.cycle_policy = V8WalkOptions::CyclePolicy::Placeholder;
+        V8JsonSink sink;
+        try
+        {
+            V8ValueWalker<V8JsonSink>(isolate, context, sink, options).Walk(value);
+        } catch (const std::runtime_error &)
+        {
+            return nullptr;
+        }
+        return std::move(sink.Result());
+    }
+
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                     const nlohmann::json &value, int depth = 0)
+    {
+        switch (value.type())
+        {
+            case nlohmann::json::value_t::null:
+                return v8::Null(isolate);
+            case nlohmann::json::value_t::boolean:
+                return v8::Boolean::New(isolate, value.get<bool>());
+            case nlohmann::json::value_t::number_integer:
+                return V8Converter<int64_t>::ToV8(isolate, context, value.get<int64_t>());
+            case nlohmann::json::value_t::number_unsigned:
+                return V8Converter<uint64_t>::ToV8(isolate, context, value.get<uint64_t>());
+            case nlohmann::json::value_t::number_float:
+                return v8::Number::New(isolate, value.get<double>());
+            case nlohmann::json::value_t::string:
+                return V8Converter<std::string>::ToV8(isolate, context, value.get_ref<const std::string &>());
+            case nlohmann::json::value_t::array:
+            {
+                CheckDepth(depth);
+                std::vector<v8::Local<v8::Value> > elements;
+                elements.reserve(value.size());
+                for (const auto &element: value)
+                {
+                    elements.push_back(ToV8(isolate, context, element, depth + 1));
+                }
+                return v8::Array::New(isolate, elements.data(), elements.size());
+            }
+            case nlohmann::json::value_t::object:
+            {
+                CheckDepth(depth);
+                const v8::Local<v8::Object> object = v8::Object::New(isolate);
+                for (const auto &[key, element]: value.items())
+                {
+                    const v8::Local<v8::String> v8_key = v8::String::NewFromUtf8(
+                        isolate, key.data(), v8::NewStringType::kNormal, static_cast<int>(key.size())).ToLocalChecked();
+                    // Plain data properties: no setters on the prototype chain are consulted
+                    object->CreateDataProperty(context, v8_key, ToV8(isolate, context, element, depth + 1)).Check();
+                }
+                return object;
+            }
+            case nlohmann::json::value_t::binary:
+            {
+                const auto &bytes = value.get_binary();
+                const v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, bytes.size());
+                if (!bytes.empty())
+                {
+                    std::memcpy(buffer->Data(), bytes.data(), bytes.size());
+                }
+                return v8::Uint8Array::New(buffer, 0, bytes.size());
+            }
+            default:
+                return v8::Undefined(isolate);
+        }
+    }
+
+private:
+    static void CheckDepth(int depth)
+    {
+        if (depth >= kMaxDepth)
+        {
+            throw std::runtime_error("JSON document exceeds the maximum nesting depth");
+        }
+    }
+};
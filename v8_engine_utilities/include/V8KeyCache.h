@@ -0,0 +1,168 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// A property name created once and reused for many Get/Set calls. Each isolate resolves it to an internalized
+// string on first use and then finds it by index, with no string allocation or hashing per access. Ids of
+// destroyed keys are reused, so the per-isolate tables stay as large as the most keys alive at once; a reused id
+// gets a new generation, which makes the isolates resolve it again.
+class PropertyKey
+{
+public:
+    explicit PropertyKey(std::string name)
+        : name_(std::move(name))
+    {
+        Acquire();
+    }
+
+    // A copy is a separate key with its own id.
+    PropertyKey(const PropertyKey &other)
+        : name_(other.name_)
+    {
+        Acquire();
+    }
+
+    PropertyKey &operator=(const PropertyKey &other)
+    {
+        name_ = other.name_;
+        Release();
+        Acquire();
+        return *this;
+    }
+
+    ~PropertyKey()
+    {
+        Release();
+    }
+
+    [[nodiscard]] const std::string &Name() const { return name_; }
+    [[nodiscard]] uint32_t Id() const { return id_; }
+    [[nodiscard]] uint32_t Generation() const { return generation_; }
+
+private:
+    std::string name_;
+    uint32_t id_ = 0;
+    uint32_t generation_ = 0;
+
+    struct Registry
+    {
+        std::mutex mutex;
+        // Current generation of every id handed out so far
+        std::vector<uint32_t> generations;
+        std::vector<uint32_t> free_ids;
+    };
+
+    static Registry &GetRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    void Acquire()
+    {
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (registry.free_ids.empty())
+        {
+            id_ = static_cast<uint32_t>(registry.generations.size());
+            registry.generations.push_back(0);
+        } else
+        {
+            id_ = registry.free_ids.back();
+            registry.free_ids.pop_back();
+            ++registry.generations[id_];
+        }
+        generation_ = registry.generations[id_];
+    }
+
+    void Release() const
+    {
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.free_ids.push_back(id_);
+    }
+};
+
+// Per-isolate cache of internalized property names. The owning engine registers it in an isolate data slot,
+// so converters can reach it from any callback on that isolate. Engine thread only.
+class V8KeyCache
+{
+public:
+    static constexpr uint32_t kIsolateDataSlot = 0;
+
+    static V8KeyCache *From(v8::Isolate *isolate)
+    {
+        return static_cast<V8KeyCache *>(isolate->GetData(kIsolateDataSlot));
+    }
+
+    // Internalized key for a string with static storage duration, such as a reflected field name, cached by
+    // address. Isolates without a cache still get an internalized string.
+    static v8::Local<v8::String> Literal(v8::Isolate *isolate, const char *literal)
+    {
+        V8KeyCache *cache = From(isolate);
+        if (cache == nullptr)
+        {
+            return v8::String::NewFromUtf8(isolate, literal, v8::NewStringType::kInternalized).ToLocalChecked();
+        }
+        v8::Global<v8::String> &key = cache->literal_keys_[literal];
+        if (key.IsEmpty())
+        {
+            key.Reset(isolate, v8::String::NewFromUtf8(isolate, literal, v8::NewStringType::kInternalized).
+                      ToLocalChecked());
+        }
+        return key.Get(isolate);
+    }
+
+    static v8::Local<v8::String> Key(v8::Isolate *isolate, const PropertyKey &key)
+    {
+        V8KeyCache *cache = From(isolate);
+        if (cache == nullptr)
+        {
+            return Internalize(isolate, key.Name());
+        }
+        if (key.Id() >= cache->property_keys_.size())
+        {
+            cache->property_keys_.resize(key.Id() + 1);
+        }
+        CachedKey &cached = cache->property_keys_[key.Id()];
+        if (cached.name.IsEmpty() || cached.generation != key.Generation())
+        {
+            // First use, or the id belonged to a key that has since been destroyed
+            cached.name.Reset(isolate, Internalize(isolate, key.Name()));
+            cached.generation = key.Generation();
+        }
+        return cached.name.Get(isolate);
+    }
+
+    static v8::Local<v8::String> Internalize(v8::Isolate *isolate, std::string_view name)
+    {
+        return v8::String::NewFromUtf8(isolate, name.data(), v8::NewStringType::kInternalized,
+                                       static_cast<int>(name.size())).ToLocalChecked();
+    }
+
+    // Must run before the isolate is disposed.
+    void Clear()
+    {
+        literal_keys_.clear();
+        property_keys_.clear();
+    }
+
+private:
+    struct CachedKey
+    {
+        v8::Global<v8::String> name;
+        uint32_t generation = 0;
+    };
+
+    std::unordered_map<const char *, v8::Global<v8::String> > literal_keys_;
+    // Indexed by PropertyKey::Id()
+    std::vector<CachedKey> property_keys_;
+};
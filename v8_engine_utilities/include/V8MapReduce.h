@@ -0,0 +1,437 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "V8EngineContext.h"
+#include "V8SerializedValue.h"
+
+// Shared between the caller and a running MapReduce. Partitions that haven't started when it is cancelled are
+// skipped; the ones being mapped finish but are not reduced.
+class V8CancellationToken
+{
+public:
+    void Cancel()
+    {
+        cancelled_.store(true, std::memory_order_release);
+    }
+
+    [[nodiscard]] bool IsCancelled() const
+    {
+        return cancelled_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+struct V8PartitionStats
+{
+    enum class State
+    {
+        Pending,
+        Reduced,
+        Failed,
+        Cancelled,
+    };
+
+    State state = State::Pending;
+    // Index of the engine in the job that mapped the partition, not its position in the pool.
+    size_t engine = 0;
+    std::chrono::microseconds map_time{0};
+    std::chrono::microseconds reduce_time{0};
+    // Size of the partial result on its way to the reducer.
+    size_t partial_bytes = 0;
+};
+
+template<typename Out>
+struct V8MapReduceResult
+{
+    // Left default-constructed unless completed.
+    Out value{};
+    // Every partition was mapped and reduced.
+    bool completed = false;
+    // First mapper, reducer or conversion failure; empty on success and on cancellation.
+    std::string error;
+    std::vector<V8PartitionStats> partitions;
+};
+
+// One MapReduce over engines already taken from the pool. Every engine compiles the mapper once and then pulls
+// partitions one at a time, so uneven partitions balance out. Partials travel in structured-clone form to the
+// first engine, which also hosts the reducer and folds them in partition order as soon as each one's turn
+// comes, so the reducer needn't be commutative. No extra threads: everything runs as tasks on the engines.
+template<typename Out, typename In>
+class V8MapReduceJob: public std::enable_shared_from_this<V8MapReduceJob<Out, In> >
+{
+public:
+    V8MapReduceJob(const std::vector<std::shared_ptr<V8EngineContext> > &engines, std::string map_source,
+                   std::string reduce_source, std::span<const In> partitions,
+                   std::shared_ptr<const V8CancellationToken> cancel)
+        : map_source_(std::move(map_source)), reduce_source_(std::move(reduce_source)), partitions_(partitions),
+          cancel_(std::move(cancel)), stats_(partitions.size())
+    {
+        for (const auto &engine: engines)
+        {
+            slots_.push_back({engine, {}});
+        }
+    }
+
+    // Blocks until every partition is settled and the engines hold no state of the job any more.
+    V8MapReduceResult<Out> Run()
+    {
+        V8MapReduceResult<Out> result;
+        if (!partitions_.empty())
+        {
+            std::future<void> done = done_.get_future();
+            for (size_t slot = 0; slot < slots_.size(); ++slot)
+            {
+                Setup(slot);
+            }
+            done.wait();
+        }
+
+        std::vector<std::promise<void> > released(slots_.size());
+        for (size_t slot = 0; slot < slots_.size(); ++slot)
+        {
+            slots_[slot].engine->ExecuteAsync([this, slot, &released, &result]()
+            {
+                if (slot == 0)
+                {
+                    TakeResult(result);
+                }
+                slots_[slot].mapper.Reset();
+                released[slot].set_value();
+            });
+        }
+        for (auto &release: released)
+        {
+            release.get_future().wait();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (result.error.empty())
+            {
+                result.error = error_;
+            }
+        }
+        result.partitions = std::move(stats_);
+        return result;
+    }
+
+private:
+    struct Slot
+    {
+        std::shared_ptr<V8EngineContext> engine;
+        v8::Global<v8::Function> mapper;
+    };
+
+    std::vector<Slot> slots_;
+    std::string map_source_;
+    std::string reduce_source_;
+    std::span<const In> partitions_;
+    std::shared_ptr<const V8CancellationToken> cancel_;
+    std::atomic<size_t> next_{0};
+    std::atomic<bool> stopped_{false};
+    // Each entry is written by one task at a time; the engine queues order the hand-over.
+    std::vector<V8PartitionStats> stats_;
+
+    std::mutex mutex_;
+    size_t finished_ = 0;
+    std::string error_;
+    std::promise<void> done_;
+
+    // Reducer state, only touched on the first engine's thread
+    v8::Global<v8::Function> reducer_;
+    v8::Global<v8::Value> accumulator_;
+    std::map<size_t, V8SerializedValue> pending_;
+    size_t next_to_reduce_ = 0;
+
+    void Setup(size_t slot)
+    {
+        auto self = this->shared_from_this();
+        slots_[slot].engine->ExecuteAsync([self, slot]()
+        {
+            v8::Isolate *isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope handle_scope(isolate);
+            const v8::Local<v8::Context> context = self->slots_[slot].engine->GetLocalContext();
+            v8::Context::Scope context_scope(context);
+            try
+            {
+                self->slots_[slot].mapper.Reset(isolate, Compile(isolate, context, self->map_source_, "mapper"));
+                if (slot == 0)
+                {
+                    self->reducer_.Reset(isolate, Compile(isolate, context, self->reduce_source_, "reducer"));
+                }
+            } catch (const std::exception &e)
+            {
+                self->Fail(e.what());
+            }
+            // Even a failed engine keeps pulling partitions, to settle them as cancelled
+            self->Pump(slot);
+        });
+    }
+
+    void Pump(size_t slot)
+    {
+        auto self = this->shared_from_this();
+        slots_[slot].engine->ExecuteAsync([self, slot]()
+        {
+            self->MapNext(slot);
+        });
+    }
+
+    void MapNext(size_t slot)
+    {
+        size_t index = next_.fetch_add(1);
+        if (index >= partitions_.size())
+        {
+            return;
+        }
+        if (cancel_ && cancel_->IsCancelled())
+        {
+            Stop();
+        }
+        if (stopped_)
+        {
+            for (; index < partitions_.size(); index = next_.fetch_add(1))
+            {
+                Finish(index, V8PartitionStats::State::Cancelled);
+            }
+            return;
+        }
+        // Queue the next partition first, so this engine keeps mapping while the partial is being reduced
+        Pump(slot);
+
+        v8::Isolate *isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope handle_scope(isolate);
+        const v8::Local<v8::Context> context = slots_[slot].engine->GetLocalContext();
+        v8::Context::Scope context_scope(context);
+        const v8::TryCatch try_catch(isolate);
+        V8PartitionStats &stats = stats_[index];
+        stats.engine = slot;
+        const auto start = std::chrono::steady_clock::now();
+        V8SerializedValue partial;
+        try
+        {
+            v8::Local<v8::Value> args[] = {
+                V8Converter<In>::ToV8(isolate, context, partitions_[index]),
+                v8::Number::New(isolate, static_cast<double>(index))
+            };
+            v8::Local<v8::Value> result;
+            if (!slots_[slot].mapper.Get(isolate)->Call(context, v8::Undefined(isolate), 2, args).ToLocal(&result))
+            {
+                throw std::runtime_error(Describe(isolate, try_catch,
+                                                  "Mapper failed on partition " + std::to_string(index)));
+            }
+            partial = Serialize(isolate, context, result, try_catch);
+        } catch (const std::exception &e)
+        {
+            stats.map_time = Elapsed(start);
+            Fail(e.what());
+            Finish(index, V8PartitionStats::State::Failed);
+            return;
+        }
+        stats.map_time = Elapsed(start);
+        stats.partial_bytes = partial.size;
+
+        auto self = this->shared_from_this();
+        slots_[0].engine->ExecuteAsync([self, index, partial = std::move(partial)]() mutable
+        {
+            self->Reduce(index, std::move(partial));
+        });
+    }
+
+    // Runs on the first engine. Partials that arrive early wait in pending_ until their predecessors are in.
+    void Reduce(size_t index, V8SerializedValue partial)
+    {
+        if (cancel_ && cancel_->IsCancelled())
+        {
+            Stop();
+        }
+        if (stopped_)
+        {
+            Finish(index, V8PartitionStats::State::Cancelled);
+            return;
+        }
+        pending_.emplace(index, std::move(partial));
+
+        v8::Isolate *isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope handle_scope(isolate);
+        const v8::Local<v8::Context> context = slots_[0].engine->GetLocalContext();
+        v8::Context::Scope context_scope(context);
+        const v8::TryCatch try_catch(isolate);
+        while (!stopped_ && !pending_.empty() && pending_.begin()->first == next_to_reduce_)
+        {
+            v8::HandleScope step_scope(isolate);
+            auto node = pending_.extract(pending_.begin());
+            const size_t current = node.key();
+            const auto start = std::chrono::steady_clock::now();
+            try
+            {
+                const v8::Local<v8::Value> value = Deserialize(isolate, context, node.mapped(), try_catch);
+                if (accumulator_.IsEmpty())
+                {
+                    accumulator_.Reset(isolate, value);
+                } else
+                {
+                    v8::Local<v8::Value> args[] = {
+                        accumulator_.Get(isolate), value, v8::Number::New(isolate, static_cast<double>(current))
+                    };
+                    v8::Local<v8::Value> result;
+                    if (!reducer_.Get(isolate)->Call(context, v8::Undefined(isolate), 3, args).ToLocal(&result))
+                    {
+                        throw std::runtime_error(Describe(isolate, try_catch,
+                                                          "Reducer failed on partition " + std::to_string(current)));
+                    }
+                    accumulator_.Reset(isolate, result);
+                }
+            } catch (const std::exception &e)
+            {
+                stats_[current].reduce_time = Elapsed(start);
+                Fail(e.what());
+                Finish(current, V8PartitionStats::State::Failed);
+                return;
+            }
+            stats_[current].reduce_time = Elapsed(start);
+            ++next_to_reduce_;
+            Finish(current, V8PartitionStats::State::Reduced);
+        }
+    }
+
+    // Runs on the first engine once everything is settled.
+    void TakeResult(V8MapReduceResult<Out> &result)
+    {
+        // A cancel that came after the last partition was pulled still counts
+        if (cancel_ && cancel_->IsCancelled())
+        {
+            stopped_ = true;
+        }
+        v8::Isolate *isolate = v8::Isolate::GetCurrent();
+        if (!stopped_ && !accumulator_.IsEmpty())
+        {
+            v8::HandleScope handle_scope(isolate);
+            const v8::Local<v8::Context> context = slots_[0].engine->GetLocalContext();
+            v8::Context::Scope context_scope(context);
+            try
+            {
+                result.value = V8Converter<Out>::FromV8(isolate, context, accumulator_.Get(isolate));
+                result.completed = true;
+            } catch (const std::exception &e)
+            {
+                result.error = std::string("Failed to convert the reduced value: ") + e.what();
+            }
+        } else if (!stopped_)
+        {
+            result.completed = true;
+        }
+        accumulator_.Reset();
+        reducer_.Reset();
+    }
+
+    void Fail(const std::string &message)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (error_.empty())
+            {
+                error_ = message;
+            }
+        }
+        Stop();
+    }
+
+    void Stop()
+    {
+        if (stopped_.exchange(true))
+        {
+            return;
+        }
+        // Partials waiting for their turn will never get it
+        auto self = this->shared_from_this();
+        slots_[0].engine->ExecuteAsync([self]()
+        {
+            for (const auto &[index, partial]: self->pending_)
+            {
+                self->Finish(index, V8PartitionStats::State::Cancelled);
+            }
+            self->pending_.clear();
+        });
+    }
+
+    void Finish(size_t index, V8PartitionStats::State state)
+    {
+        stats_[index].state = state;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (++finished_ == partitions_.size())
+        {
+            done_.set_value();
+        }
+    }
+
+    static std::chrono::microseconds Elapsed(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    }
+
+    static std::string Describe(v8::Isolate *isolate, const v8::TryCatch &try_catch, const std::string &what)
+    {
+        const v8::String::Utf8Value error(isolate, try_catch.Exception());
+        return what + ": " + (*error ? *error : "unknown error");
+    }
+
+    // Sources are function expressions, e.g. "(partition, index) => partition.length".
+    static v8::Local<v8::Function> Compile(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                           const std::string &source, const char *what)
+    {
+        const v8::TryCatch try_catch(isolate);
+        const std::string expression = "(" + source + "\n)";
+        v8::Local<v8::String> code;
+        v8::Local<v8::Script> script;
+        v8::Local<v8::Value> function;
+        if (!v8::String::NewFromUtf8(isolate, expression.data(), v8::NewStringType::kNormal,
+                                     static_cast<int>(expression.size())).ToLocal(&code) ||
+            !v8::Script::Compile(context, code).ToLocal(&script) || !script->Run(context).ToLocal(&function))
+        {
+            throw std::runtime_error(Describe(isolate, try_catch, std::string("Failed to compile the ") + what));
+        }
+        if (!function->IsFunction())
+        {
+            throw std::runtime_error(std::string("The ") + what + " source is not a function");
+        }
+        return function.As<v8::Function>();
+    }
+
+    static V8SerializedValue Serialize(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                       v8::Local<v8::Value> value, const v8::TryCatch &try_catch)
+    {
+        std::optional<V8SerializedValue> serialized = V8SerializedValue::Write(isolate, context, value);
+        if (!serialized)
+        {
+            throw std::runtime_error(Describe(isolate, try_catch, "Failed to serialize a partial result"));
+        }
+        return std::move(*serialized);
+    }
+
+    static v8::Local<v8::Value> Deserialize(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                            const V8SerializedValue &serialized, const v8::TryCatch &try_catch)
+    {
+        v8::Local<v8::Value> value;
+        if (!serialized.Read(isolate, context).ToLocal(&value))
+        {
+            throw std::runtime_error(Describe(isolate, try_catch, "Failed to deserialize a partial result"));
+        }
+        return value;
+    }
+};
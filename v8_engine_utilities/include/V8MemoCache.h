@@ -0,0 +1,281 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+struct V8MemoCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // Entries dropped to stay within the size bound.
+    uint64_t evictions = 0;
+    // Entries found past their TTL; they count as misses too.
+    uint64_t expirations = 0;
+    size_t size = 0;
+};
+
+// Results of memoized JS functions, shared by all engines of a pool. Entries are keyed by function, generation
+// and the serialized arguments; lookups and inserts lock one of several shards only, and each shard drops its
+// least recently used entry when full. Values are type-erased; V8MemoizedFunction knows their type.
+class V8MemoCache
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Key
+    {
+        uint64_t function_id = 0;
+        // Bumped by V8MemoizedFunction::Invalidate and by every bootstrap reload.
+        uint64_t generation = 0;
+        uint64_t epoch = 0;
+        // Arguments in MessagePack; compared in full, so hash collisions never return a wrong result.
+        std::vector<uint8_t> arguments;
+        uint64_t hash = 0;
+
+        bool operator==(const Key &other) const
+        {
+            return hash == other.hash && function_id == other.function_id && generation == other.generation &&
+                   epoch == other.epoch && arguments == other.arguments;
+        }
+    };
+
+    explicit V8MemoCache(size_t max_entries = 65536, size_t shard_count = 16)
+        : shards_(std::max<size_t>(shard_count, 1))
+    {
+        shard_capacity_ = std::max<size_t>((max_entries + shards_.size() - 1) / shards_.size(), 1);
+    }
+
+    V8MemoCache(const V8MemoCache &) = delete;
+    V8MemoCache &operator=(const V8MemoCache &) = delete;
+
+    [[nodiscard]] static uint64_t NewFunctionId()
+    {
+        static std::atomic<uint64_t> next_id{1};
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t Epoch() const
+    {
+        return epoch_.load(std::memory_order_acquire);
+    }
+
+    // Serializes the arguments as a JSON array. Objects have sorted keys, so equal structures give equal keys.
+    [[nodiscard]] Key MakeKey(uint64_t function_id, uint64_t generation, const nlohmann::json &arguments) const
+    {
+        Key key;
+        key.function_id = function_id;
+        key.generation = generation;
+        key.epoch = Epoch();
+        key.arguments = nlohmann::json::to_msgpack(arguments);
+        // FNV-1a over the bytes, seeded with the rest of the key
+        uint64_t hash = 14695981039346656037ull ^ (function_id * 0x9e3779b97f4a7c15ull) ^ (generation << 32) ^ key.epoch;
+        for (const uint8_t byte: key.arguments)
+        {
+            hash = (hash ^ byte) * 1099511628211ull;
+        }
+        // FNV leaves the high bits poorly mixed for short inputs, and the shard is picked from them
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        key.hash = hash;
+        return key;
+    }
+
+    [[nodiscard]] std::shared_ptr<const void> Find(const Key &key)
+    {
+        Shard &shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto it = shard.entries.find(key);
+        if (it == shard.entries.end())
+        {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        if (Clock::now() >= it->second.expires)
+        {
+            shard.lru.erase(it->second.lru);
+            shard.entries.erase(it);
+            expirations_.fetch_add(1, std::memory_order_relaxed);
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second.value;
+    }
+
+    // A zero ttl never expires.
+    void Insert(Key key, std::shared_ptr<const void> value, std::chrono::milliseconds ttl)
+    {
+        const Clock::time_point expires = ttl.count() > 0 ? Clock::now() + ttl : Clock::time_point::max();
+        Shard &shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto [it, inserted] = shard.entries.try_emplace(std::move(key));
+        it->second.value = std::move(value);
+        it->second.expires = expires;
+        if (!inserted)
+        {
+            // Another engine computed the same call concurrently
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+            return;
+        }
+        shard.lru.push_front(&it->first);
+        it->second.lru = shard.lru.begin();
+        if (shard.entries.size() > shard_capacity_)
+        {
+            shard.entries.erase(shard.entries.find(*shard.lru.back()));
+            shard.lru.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Drops every entry of one function.
+    void Erase(uint64_t function_id)
+    {
+        for (Shard &shard: shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.lru.begin(); it != shard.lru.end();)
+            {
+                if ((*it)->function_id == function_id)
+                {
+                    shard.entries.erase(shard.entries.find(**it));
+                    it = shard.lru.erase(it);
+                } else
+                {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    // Drops every entry; calls already running when it is called store their results under the old epoch,
+    // where no later lookup finds them.
+    void InvalidateAll()
+    {
+        epoch_.fetch_add(1, std::memory_order_acq_rel);
+        for (Shard &shard: shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.entries.clear();
+            shard.lru.clear();
+        }
+    }
+
+    [[nodiscard]] V8MemoCacheStats GetStats()
+    {
+        V8MemoCacheStats stats;
+        stats.hits = hits_.load(std::memory_order_relaxed);
+        stats.misses = misses_.load(std::memory_order_relaxed);
+        stats.evictions = evictions_.load(std::memory_order_relaxed);
+        stats.expirations = expirations_.load(std::memory_order_relaxed);
+        for (Shard &shard: shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.size += shard.entries.size();
+        }
+        return stats;
+    }
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            return static_cast<size_t>(key.hash);
+        }
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<const void> value;
+        Clock::time_point expires;
+        std::list<const Key *>::iterator lru;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<Key, Entry, KeyHash> entries;
+        // Keys of entries, most recently used first; map nodes don't move, so the pointers stay valid.
+        std::list<const Key *> lru;
+    };
+
+    std::vector<Shard> shards_;
+    size_t shard_capacity_;
+    std::atomic<uint64_t> epoch_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> expirations_{0};
+
+    Shard &GetShard(const Key &key)
+    {
+        // The map buckets use the low bits, so the shard takes the high ones
+        return shards_[(key.hash >> 48) % shards_.size()];
+    }
+};
+
+// A JS function whose results are cached in a V8MemoCache by argument values. Only for pure functions: a hit
+// returns the stored result without touching any engine. Arguments must convert to nlohmann::json for the key
+// and through V8Converter for the call.
+template<typename Out, typename... Args>
+class V8MemoizedFunction
+{
+public:
+    using Invoke = std::function<Out(const Args &...)>;
+
+    V8MemoizedFunction(std::shared_ptr<V8MemoCache> cache, Invoke invoke, std::chrono::milliseconds ttl)
+        : cache_(std::move(cache)), invoke_(std::move(invoke)), ttl_(ttl), id_(V8MemoCache::NewFunctionId())
+    {
+    }
+
+    V8MemoizedFunction(const V8MemoizedFunction &) = delete;
+    V8MemoizedFunction &operator=(const V8MemoizedFunction &) = delete;
+
+    Out operator()(const Args &... args)
+    {
+        return Call(args...);
+    }
+
+    // Exceptions from the call propagate and are not cached.
+    Out Call(const Args &... args)
+    {
+        nlohmann::json arguments = nlohmann::json::array();
+        (arguments.push_back(args), ...);
+        V8MemoCache::Key key = cache_->MakeKey(id_, generation_.load(std::memory_order_acquire), arguments);
+        if (const std::shared_ptr<const void> cached = cache_->Find(key))
+        {
+            return *std::static_pointer_cast<const Out>(cached);
+        }
+        Out result = invoke_(args...);
+        cache_->Insert(std::move(key), std::make_shared<const Out>(result), ttl_);
+        return result;
+    }
+
+    // Forgets every cached result of this function, e.g. after the data it reads changed.
+    void Invalidate()
+    {
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+        cache_->Erase(id_);
+    }
+
+private:
+    std::shared_ptr<V8MemoCache> cache_;
+    Invoke invoke_;
+    std::chrono::milliseconds ttl_;
+    uint64_t id_;
+    std::atomic<uint64_t> generation_{0};
+};
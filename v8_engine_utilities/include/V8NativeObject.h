@@ -0,0 +1,285 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+class V8NativeDataSource;
+
+// A field or element of a native data source. std::monostate means "no such property"; a nested source becomes
+// another lazy object.
+using V8NativeValue = std::variant<std::monostate, std::nullptr_t, bool, double, std::string,
+                                   std::shared_ptr<V8NativeDataSource> >;
+
+// Map-like and/or array-like native record read by JS on demand. Only the fields and elements a script touches
+// are ever requested. Called on the engine thread; a source exposed to several engines is called from each of
+// their threads and must be safe for that.
+class V8NativeDataSource
+{
+public:
+    virtual ~V8NativeDataSource() = default;
+
+    [[nodiscard]] virtual V8NativeValue GetField(std::string_view name) const
+    {
+        return {};
+    }
+
+    // Used for Object.keys, for...in and JSON.stringify.
+    [[nodiscard]] virtual std::vector<std::string> GetFieldNames() const
+    {
+        return {};
+    }
+
+    // Array-like sources report their element count, which JS also sees as `length`.
+    [[nodiscard]] virtual size_t GetLength() const
+    {
+        return 0;
+    }
+
+    [[nodiscard]] virtual V8NativeValue GetElement(size_t index) const
+    {
+        return {};
+    }
+};
+
+// Builds JS objects whose properties come from a V8NativeDataSource through named and indexed interceptors.
+// A property is converted on its first read and then stored on the object as a plain data property; the
+// interceptors are non-masking, so later reads never leave V8. Owned by a single engine and only touched from
+// its execution thread.
+class V8NativeObjectFactory
+{
+public:
+    V8NativeObjectFactory() = default;
+
+    V8NativeObjectFactory(const V8NativeObjectFactory &) = delete;
+    V8NativeObjectFactory &operator=(const V8NativeObjectFactory &) = delete;
+
+    ~V8NativeObjectFactory()
+    {
+        Clear();
+    }
+
+    v8::MaybeLocal<v8::Object> NewInstance(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                           std::shared_ptr<V8NativeDataSource> source)
+    {
+        v8::EscapableHandleScope handle_scope(isolate);
+        v8::Local<v8::Object> object;
+        if (!GetTemplate(isolate)->NewInstance(context).ToLocal(&object))
+        {
+            return {};
+        }
+        auto holder = std::make_unique<Holder>();
+        holder->factory = this;
+        holder->source = std::move(source);
+        holder->object.Reset(isolate, object);
+        holder->object.SetWeak(holder.get(), OnCollected, v8::WeakCallbackType::kParameter);
+        object->SetAlignedPointerInInternalField(0, holder.get());
+        Holder *key = holder.get();
+        holders_.emplace(key, std::move(holder));
+        return handle_scope.Escape(object);
+    }
+
+    // Must run before the isolate is disposed; objects still alive in JS lose their source.
+    void Clear()
+    {
+        for (auto &[key, holder]: holders_)
+        {
+            holder->object.Reset();
+        }
+        holders_.clear();
+        object_template_.Reset();
+    }
+
+private:
+    struct Holder
+    {
+        V8NativeObjectFactory *factory;
+        std::shared_ptr<V8NativeDataSource> source;
+        v8::Global<v8::Object> object;
+    };
+
+    std::unordered_map<Holder *, std::unique_ptr<Holder> > holders_;
+    v8::Global<v8::ObjectTemplate> object_template_;
+
+    v8::Local<v8::ObjectTemplate> GetTemplate(v8::Isolate *isolate)
+    {
+        if (object_template_.IsEmpty())
+        {
+            const v8::Local<v8::ObjectTemplate> object_template = v8::ObjectTemplate::New(isolate);
+            object_template->SetInternalFieldCount(1);
+            object_template->SetHandler(v8::NamedPropertyHandlerConfiguration(
+                GetNamed, nullptr, QueryNamed, nullptr, EnumerateNamed, v8::Local<v8::Value>(),
+                static_cast<v8::PropertyHandlerFlags>(
+                    static_cast<int>(v8::PropertyHandlerFlags::kNonMasking) |
+                    static_cast<int>(v8::PropertyHandlerFlags::kOnlyInterceptStrings))));
+            object_template->SetHandler(v8::IndexedPropertyHandlerConfiguration(
+                GetIndexed, nullptr, QueryIndexed, nullptr, EnumerateIndexed, nullptr, nullptr,
+                v8::Local<v8::Value>(), v8::PropertyHandlerFlags::kNonMasking));
+            object_template_.Reset(isolate, object_template);
+        }
+        return object_template_.Get(isolate);
+    }
+
+    static void OnCollected(const v8::WeakCallbackInfo<Holder> &info)
+    {
+        Holder *holder = info.GetParameter();
+        holder->object.Reset();
+        holder->factory->holders_.erase(holder);
+    }
+
+    static const Holder *GetHolder(v8::Local<v8::Object> object)
+    {
+        return static_cast<const Holder *>(object->GetAlignedPointerFromInternalField(0));
+    }
+
+    // Converts a value read from the source and stores it on the object, so the next read is a plain
+    // property load. Nested sources get their own object, which keeps `a.b === a.b`.
+    template<typename Key>
+    static v8::Intercepted Materialize(const v8::PropertyCallbackInfo<v8::Value> &info, Key key,
+                                       const V8NativeValue &native)
+    {
+        if (std::holds_alternative<std::monostate>(native))
+        {
+            return v8::Intercepted::kNo;
+        }
+        v8::Isolate *isolate = info.GetIsolate();
+        const v8::Local<v8::Context> context = isolate->GetCurrentContext();
+        const v8::Local<v8::Object> object = info.Holder();
+        v8::Local<v8::Value> value;
+        if (!ToV8(isolate, context, object, native).ToLocal(&value))
+        {
+            return v8::Intercepted::kNo;
+        }
+        if (object->CreateDataProperty(context, key, value).IsNothing())
+        {
+            return v8::Intercepted::kNo;
+        }
+        info.GetReturnValue().Set(value);
+        return v8::Intercepted::kYes;
+    }
+
+    static v8::MaybeLocal<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                          v8::Local<v8::Object> owner, const V8NativeValue &native)
+    {
+        if (std::holds_alternative<std::nullptr_t>(native))
+        {
+            return v8::Null(isolate);
+        }
+        if (const bool *boolean = std::get_if<bool>(&native))
+        {
+            return v8::Boolean::New(isolate, *boolean);
+        }
+        if (const double *number = std::get_if<double>(&native))
+        {
+            return v8::Number::New(isolate, *number);
+        }
+        if (const std::string *string = std::get_if<std::string>(&native))
+        {
+            v8::Local<v8::String> result;
+            if (!v8::String::NewFromUtf8(isolate, string->data(), v8::NewStringType::kNormal,
+                                         static_cast<int>(string->size())).ToLocal(&result))
+            {
+                return {};
+            }
+            return result;
+        }
+        const auto &nested = std::get<std::shared_ptr<V8NativeDataSource> >(native);
+        if (!nested)
+        {
+            return v8::Null(isolate);
+        }
+        v8::Local<v8::Object> object;
+        if (!GetHolder(owner)->factory->NewInstance(isolate, context, nested).ToLocal(&object))
+        {
+            return {};
+        }
+        return object;
+    }
+
+    static v8::Intercepted GetNamed(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info)
+    {
+        const Holder *holder = GetHolder(info.Holder());
+        v8::Isolate *isolate = info.GetIsolate();
+        const v8::String::Utf8Value name(isolate, property);
+        const std::string_view field(*name, name.length());
+        V8NativeValue native = holder->source->GetField(field);
+        if (std::holds_alternative<std::monostate>(native) && field == "length")
+        {
+            const size_t length = holder->source->GetLength();
+            if (length > 0)
+            {
+                native = static_cast<double>(length);
+            }
+        }
+        return Materialize(info, property, native);
+    }
+
+    static v8::Intercepted GetIndexed(uint32_t index, const v8::PropertyCallbackInfo<v8::Value> &info)
+    {
+        const Holder *holder = GetHolder(info.Holder());
+        if (index >= holder->source->GetLength())
+        {
+            return v8::Intercepted::kNo;
+        }
+        return Materialize(info, index, holder->source->GetElement(index));
+    }
+
+    static v8::Intercepted QueryNamed(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Integer> &info)
+    {
+        const Holder *holder = GetHolder(info.Holder());
+        const v8::String::Utf8Value name(info.GetIsolate(), property);
+        const std::string_view field(*name, name.length());
+        if (std::holds_alternative<std::monostate>(holder->source->GetField(field)) &&
+            (field != "length" || holder->source->GetLength() == 0))
+        {
+            return v8::Intercepted::kNo;
+        }
+        info.GetReturnValue().Set(static_cast<int32_t>(v8::None));
+        return v8::Intercepted::kYes;
+    }
+
+    static v8::Intercepted QueryIndexed(uint32_t index, const v8::PropertyCallbackInfo<v8::Integer> &info)
+    {
+        if (index >= GetHolder(info.Holder())->source->GetLength())
+        {
+            return v8::Intercepted::kNo;
+        }
+        info.GetReturnValue().Set(static_cast<int32_t>(v8::None));
+        return v8::Intercepted::kYes;
+    }
+
+    static void EnumerateNamed(const v8::PropertyCallbackInfo<v8::Array> &info)
+    {
+        v8::Isolate *isolate = info.GetIsolate();
+        const std::vector<std::string> names = GetHolder(info.Holder())->source->GetFieldNames();
+        std::vector<v8::Local<v8::Value> > keys;
+        keys.reserve(names.size());
+        for (const auto &name: names)
+        {
+            keys.push_back(v8::String::NewFromUtf8(isolate, name.data(), v8::NewStringType::kInternalized,
+                                                   static_cast<int>(name.size())).ToLocalChecked());
+        }
+        info.GetReturnValue().Set(v8::Array::New(isolate, keys.data(), keys.size()));
+    }
+
+    static void EnumerateIndexed(const v8::PropertyCallbackInfo<v8::Array> &info)
+    {
+        v8::Isolate *isolate = info.GetIsolate();
+        const size_t length = GetHolder(info.Holder())->source->GetLength();
+        const v8::Local<v8::Context> context = isolate->GetCurrentContext();
+        const v8::Local<v8::Array> indices = v8::Array::New(isolate, static_cast<int>(length));
+        for (size_t i = 0; i < length; ++i)
+        {
+            indices->Set(context, static_cast<uint32_t>(i),
+                         v8::Integer::NewFromUnsigned(isolate, static_cast<uint32_t>(i))).Check();
+        }
+        info.GetReturnValue().Set(indices);
+    }
+};
@@ -0,0 +1,190 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+template<typename T>
+struct IsV8NumericElement : std::bool_constant<std::is_arithmetic_v<T> && !std::is_same_v<T, bool> >
+{
+};
+
+// Bulk conversion of typed arrays and arrays of numbers to std::vector<T>, without a Get() and a handle per
+// element. Conversions keep the element-wise semantics of V8Converter<T>: numbers convert to integers like
+// IntegerValue() (NaN to 0, truncated, clamped to int64) and then narrow with a plain cast.
+template<typename T>
+struct V8NumericArray
+{
+    static_assert(IsV8NumericElement<T>::value, "V8NumericArray needs an arithmetic element type");
+
+    // Returns false when value is not a typed array of a known element type.
+    static bool FromTypedArray(v8::Local<v8::Value> value, std::vector<T> &out)
+    {
+        if (!value->IsTypedArray())
+        {
+            return false;
+        }
+        const v8::Local<v8::TypedArray> array = value.As<v8::TypedArray>();
+        if (value->IsFloat64Array())
+        {
+            CopyFrom<double>(array, out);
+        } else if (value->IsFloat32Array())
+        {
+            CopyFrom<float>(array, out);
+        } else if (value->IsInt32Array())
+        {
+            CopyFrom<int32_t>(array, out);
+        } else if (value->IsUint32Array())
+        {
+            CopyFrom<uint32_t>(array, out);
+        } else if (value->IsInt16Array())
+        {
+            CopyFrom<int16_t>(array, out);
+        } else if (value->IsUint16Array())
+        {
+            CopyFrom<uint16_t>(array, out);
+        } else if (value->IsInt8Array())
+        {
+            CopyFrom<int8_t>(array, out);
+        } else if (value->IsUint8Array() || value->IsUint8ClampedArray())
+        {
+            CopyFrom<uint8_t>(array, out);
+        } else if (value->IsBigInt64Array())
+        {
+            CopyFrom<int64_t>(array, out);
+        } else if (value->IsBigUint64Array())
+        {
+            CopyFrom<uint64_t>(array, out);
+        } else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // Typed array of the kind matching T (Float64Array for double, ...) over length elements of buffer.
+    static v8::Local<v8::TypedArray> NewTypedArray(v8::Local<v8::ArrayBuffer> buffer, size_t length)
+    {
+        if constexpr (std::is_same_v<T, int8_t>) return v8::Int8Array::New(buffer, 0, length);
+        else if constexpr (std::is_same_v<T, uint8_t>) return v8::Uint8Array::New(buffer, 0, length);
+        else if constexpr (std::is_same_v<T, int16_t>) return v8::Int16Array::New(buffer, 0, length);
+        else if constexpr (std::is_same_v<T, uint16_t>) return v8::Uint16Array::New(buffer, 0, length);
+        else if constexpr (std::is_same_v<T, int32_t>) return v8::Int32Array::New(buffer, 0, length);
+        else if constexpr (std::is_same_v<T, uint32_t>) return v8::Uint32Array::New(buffer, 0, length);
+        else if constexpr (std::is_same_v<T, float>) return v8::Float32Array::New(buffer, 0, length);
+        else if constexpr (std::is_same_v<T, double>) return v8::Float64Array::New(buffer, 0, length);
+        else if constexpr (std::is_same_v<T, int64_t>) return v8::BigInt64Array::New(buffer, 0, length);
+        else if constexpr (std::is_same_v<T, uint64_t>) return v8::BigUint64Array::New(buffer, 0, length);
+        else static_assert(sizeof(T) == 0, "No typed array matches this element type");
+    }
+
+    // Reads an array whose elements are all numbers in one Array::Iterate pass, which walks packed SMI and
+    // double elements directly. Returns false, leaving out unspecified, on the first element that is not a
+    // number (holes included); the caller then falls back to per-element conversion.
+    static bool FromNumberArray(v8::Local<v8::Context> context, v8::Local<v8::Array> array, std::vector<T> &out)
+    {
+        out.resize(array->Length());
+        IterationState state{out.data(), out.size(), true};
+        if (array->Iterate(context, Visit, &state).IsNothing())
+        {
+            return false;
+        }
+        return state.numeric;
+    }
+
+private:
+    struct IterationState
+    {
+        T *out;
+        size_t size;
+        bool numeric;
+    };
+
+    // Must not allocate or call into V8, see Array::Iterate.
+    static v8::Array::CallbackResult Visit(uint32_t index, v8::Local<v8::Value> element, void *data)
+    {
+        auto *state = static_cast<IterationState *>(data);
+        if (index >= state->size || !element->IsNumber())
+        {
+            state->numeric = false;
+            return v8::Array::CallbackResult::kBreak;
+        }
+        state->out[index] = FromNumber(element.As<v8::Number>()->Value());
+        return v8::Array::CallbackResult::kContinue;
+    }
+
+    template<typename Source>
+    static void CopyFrom(v8::Local<v8::TypedArray> array, std::vector<T> &out)
+    {
+        const size_t length = array->Length();
+        out.resize(length);
+        if (length == 0)
+        {
+            return;
+        }
+        if constexpr (std::is_same_v<Source, T>)
+        {
+            array->CopyContents(out.data(), length * sizeof(T));
+        } else if (array->HasBuffer())
+        {
+            // Convert straight out of the backing store. The offset of a typed array is always a multiple of
+            // its element size, so the source is suitably aligned.
+            const auto *bytes = static_cast<const std::byte *>(array->Buffer()->Data()) + array->ByteOffset();
+            Convert(reinterpret_cast<const Source *>(bytes), length, out.data());
+        } else
+        {
+            // Small typed arrays live on the JS heap; asking for their buffer would move them off it
+            std::vector<Source> source(length);
+            array->CopyContents(source.data(), length * sizeof(Source));
+            Convert(source.data(), length, out.data());
+        }
+    }
+
+    // Plain loops over contiguous memory without aliasing or calls, which the compiler auto-vectorizes.
+    template<typename Source>
+    static void Convert(const Source *__restrict source, size_t length, T *__restrict out)
+    {
+        if constexpr (std::is_floating_point_v<Source> && std::is_integral_v<T>)
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                out[i] = FromNumber(static_cast<double>(source[i]));
+            }
+        } else
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                out[i] = static_cast<T>(source[i]);
+            }
+        }
+    }
+
+    static T FromNumber(double value)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return static_cast<T>(value);
+        } else
+        {
+            if (std::isnan(value))
+            {
+                return 0;
+            }
+            if (value >= 9223372036854775808.0)
+            {
+                return static_cast<T>(std::numeric_limits<int64_t>::max());
+            }
+            if (value < -9223372036854775808.0)
+            {
+                return static_cast<T>(std::numeric_limits<int64_t>::min());
+            }
+            return static_cast<T>(static_cast<int64_t>(value));
+        }
+    }
+};
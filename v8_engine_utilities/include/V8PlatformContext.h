@@ -4,6 +4,7 @@
 #pragma once
 #include <v8.h>
 #include <libplatform/libplatform.h>
+#include <memory>
 
 class V8PlatformContext
 {
@@ -15,6 +16,9 @@ public:
         platform = v8::platform::NewDefaultPlatform();
         v8::V8::InitializePlatform(platform.get());
         v8::V8::Initialize();
+        // Shared by every engine so backing stores can outlive the isolate that allocated them and move between engines
+        array_buffer_allocator = std::shared_ptr<v8::ArrayBuffer::Allocator>(
+            v8::ArrayBuffer::Allocator::NewDefaultAllocator());
     }
 
     ~V8PlatformContext()
@@ -29,6 +33,12 @@ public:
         return platform;
     }
 
+    [[nodiscard]] std::shared_ptr<v8::ArrayBuffer::Allocator> GetArrayBufferAllocator() const
+    {
+        return array_buffer_allocator;
+    }
+
 private:
     std::shared_ptr<v8::Platform> platform;
+    std::shared_ptr<v8::ArrayBuffer::Allocator> array_buffer_allocator;
 };
@@ -0,0 +1,69 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+// A value in V8's structured-clone wire format, detached from the isolate that produced it.
+// Any engine of the pool can deserialize it, and it can be deserialized more than once.
+struct V8SerializedValue
+{
+    std::shared_ptr<const uint8_t> data;
+    size_t size = 0;
+    // Backing stores of transferred ArrayBuffers, in transfer-id order. They move to the receiving engine
+    // uncopied; deserializing the same value twice makes both engines alias that memory.
+    std::vector<std::shared_ptr<v8::BackingStore> > array_buffers;
+
+    // Serializes the value with the transfers given ids in order; detaching them is up to the caller. Returns
+    // nothing, with the JS exception pending, when the value can't be cloned.
+    static std::optional<V8SerializedValue> Write(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                                  v8::Local<v8::Value> value,
+                                                  std::span<const v8::Local<v8::ArrayBuffer> > transfers = {})
+    {
+        v8::ValueSerializer serializer(isolate);
+        serializer.WriteHeader();
+        for (size_t i = 0; i < transfers.size(); ++i)
+        {
+            serializer.TransferArrayBuffer(static_cast<uint32_t>(i), transfers[i]);
+        }
+        if (serializer.WriteValue(context, value).IsNothing())
+        {
+            return std::nullopt;
+        }
+        V8SerializedValue serialized;
+        const auto [buffer, size] = serializer.Release();
+        // ValueSerializer grows its buffer with realloc
+        serialized.data = std::shared_ptr<const uint8_t>(buffer, [](const uint8_t *data)
+        {
+            std::free(const_cast<uint8_t *>(data));
+        });
+        serialized.size = size;
+        for (const v8::Local<v8::ArrayBuffer> &array_buffer: transfers)
+        {
+            serialized.array_buffers.push_back(array_buffer->GetBackingStore());
+        }
+        return serialized;
+    }
+
+    // Recreates the value in the given context. Returns an empty handle, with the JS exception pending when
+    // there is one, on malformed data.
+    [[nodiscard]] v8::MaybeLocal<v8::Value> Read(v8::Isolate *isolate, v8::Local<v8::Context> context) const
+    {
+        v8::ValueDeserializer deserializer(isolate, data.get(), size);
+        if (deserializer.ReadHeader(context).IsNothing())
+        {
+            return {};
+        }
+        for (size_t i = 0; i < array_buffers.size(); ++i)
+        {
+            deserializer.TransferArrayBuffer(static_cast<uint32_t>(i), v8::ArrayBuffer::New(isolate, array_buffers[i]));
+        }
+        return deserializer.ReadValue(context);
+    }
+};
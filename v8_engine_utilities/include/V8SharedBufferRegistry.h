@@ -0,0 +1,85 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "V8BufferView.h"
+
+// Named SharedArrayBuffer backing stores shared by every engine of a pool. Each engine injects them as globals
+// into every fresh context, so read-mostly data (lookup tables, model weights) exists once per process
+// rather than once per isolate.
+//
+// JS coordinates through Atomics on typed arrays over these buffers. Native code can take part through
+// std::atomic_ref on the same 32-bit cells, e.g. std::atomic_ref<int32_t>(view.As<int32_t>()[0]).
+// Atomics.wait only wakes for Atomics.notify from other engines, not for native stores.
+class V8SharedBufferRegistry
+{
+public:
+    explicit V8SharedBufferRegistry(std::shared_ptr<v8::ArrayBuffer::Allocator> allocator)
+        : allocator_(std::move(allocator))
+    {
+    }
+
+    // Allocates zeroed memory from the engines' allocator, inside the V8 sandbox when it is enabled. Returns a
+    // view for native initialization. Engines pick the buffer up at their next reset.
+    V8BufferView Register(const std::string &name, size_t byte_length)
+    {
+        void *data = allocator_->Allocate(byte_length);
+        if (data == nullptr && byte_length != 0)
+        {
+            throw std::bad_alloc();
+        }
+        std::shared_ptr<v8::BackingStore> backing_store = v8::SharedArrayBuffer::NewBackingStore(
+            data, byte_length, [](void *memory, size_t length, void *deleter_data)
+            {
+                auto *owner = static_cast<std::shared_ptr<v8::ArrayBuffer::Allocator> *>(deleter_data);
+                (*owner)->Free(memory, length);
+                delete owner;
+            }, new std::shared_ptr<v8::ArrayBuffer::Allocator>(allocator_));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffers_[name] = backing_store;
+        return MakeView(backing_store);
+    }
+
+    [[nodiscard]] V8BufferView Get(const std::string &name) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = buffers_.find(name);
+        if (it == buffers_.end())
+        {
+            throw std::runtime_error("Unknown shared buffer: " + name);
+        }
+        return MakeView(it->second);
+    }
+
+    // Contexts that already hold the buffer keep it; the memory is freed once the last of them is gone.
+    void Remove(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffers_.erase(name);
+    }
+
+    [[nodiscard]] std::vector<std::pair<std::string, std::shared_ptr<v8::BackingStore> > > Snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {buffers_.begin(), buffers_.end()};
+    }
+
+private:
+    std::shared_ptr<v8::ArrayBuffer::Allocator> allocator_;
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<v8::BackingStore> > buffers_;
+
+    static V8BufferView MakeView(const std::shared_ptr<v8::BackingStore> &backing_store)
+    {
+        auto *data = static_cast<std::byte *>(backing_store->Data());
+        return {backing_store, data ? std::span<std::byte>(data, backing_store->ByteLength()) : std::span<std::byte>()};
+    }
+};
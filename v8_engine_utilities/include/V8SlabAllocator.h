@@ -0,0 +1,167 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Free lists of fixed-size blocks carved from larger slabs. Each thread allocates from and frees into its own
+// cache without locking; the shared list is only touched to move whole batches between threads, e.g. when wrappers
+// created on an engine thread are dropped on the caller's. Slabs are kept for the lifetime of the process, so a
+// block freed after its engine is gone is still valid.
+template<size_t BlockSize, size_t Alignment>
+class V8SlabPool
+{
+public:
+    static V8SlabPool &Instance()
+    {
+        // Intentionally leaked: wrappers may be released during static destruction.
+        static auto *pool = new V8SlabPool();
+        return *pool;
+    }
+
+    void *Allocate()
+    {
+        LocalCache &cache = Local();
+        if (cache.head == nullptr)
+        {
+            Refill(cache);
+        }
+        Block *block = cache.head;
+        cache.head = block->next;
+        --cache.count;
+        return block->storage;
+    }
+
+    void Deallocate(void *pointer)
+    {
+        auto *block = reinterpret_cast<Block *>(pointer);
+        LocalCache &cache = Local();
+        block->next = cache.head;
+        cache.head = block;
+        if (++cache.count >= 2 * kBatchSize)
+        {
+            Flush(cache, kBatchSize);
+        }
+    }
+
+private:
+    static constexpr size_t kBlocksPerSlab = 256;
+    static constexpr size_t kBatchSize = 64;
+
+    union Block
+    {
+        Block *next;
+        alignas(Alignment) unsigned char storage[BlockSize];
+    };
+
+    struct Batch
+    {
+        Block *head;
+        size_t count;
+    };
+
+    struct LocalCache
+    {
+        Block *head = nullptr;
+        size_t count = 0;
+
+        ~LocalCache()
+        {
+            // Blocks cached by an exiting thread go back to the others
+            Instance().Flush(*this, count);
+        }
+    };
+
+    std::mutex mutex_;
+    std::vector<Batch> batches_;
+
+    static LocalCache &Local()
+    {
+        static thread_local LocalCache cache;
+        return cache;
+    }
+
+    void Refill(LocalCache &cache)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!batches_.empty())
+            {
+                cache.head = batches_.back().head;
+                cache.count = batches_.back().count;
+                batches_.pop_back();
+                return;
+            }
+        }
+        Block *slab = new Block[kBlocksPerSlab];
+        for (size_t i = 0; i < kBlocksPerSlab; ++i)
+        {
+            slab[i].next = i + 1 < kBlocksPerSlab ? &slab[i + 1] : nullptr;
+        }
+        cache.head = slab;
+        cache.count = kBlocksPerSlab;
+    }
+
+    // Moves the first count blocks of the cache to the shared list as one batch.
+    void Flush(LocalCache &cache, size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        Block *head = cache.head;
+        Block *tail = head;
+        for (size_t i = 1; i < count; ++i)
+        {
+            tail = tail->next;
+        }
+        cache.head = tail->next;
+        cache.count -= count;
+        tail->next = nullptr;
+        std::lock_guard<std::mutex> lock(mutex_);
+        batches_.push_back({head, count});
+    }
+};
+
+// Allocator for std::allocate_shared: the object and its control block share one pooled block.
+template<typename T>
+class V8SlabAllocator
+{
+public:
+    using value_type = T;
+
+    V8SlabAllocator() noexcept = default;
+
+    template<typename U>
+    V8SlabAllocator(const V8SlabAllocator<U> &) noexcept
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        if (n != 1)
+        {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T *>(V8SlabPool<sizeof(T), alignof(T)>::Instance().Allocate());
+    }
+
+    void deallocate(T *pointer, size_t n) noexcept
+    {
+        if (n != 1)
+        {
+            std::allocator<T>().deallocate(pointer, n);
+            return;
+        }
+        V8SlabPool<sizeof(T), alignof(T)>::Instance().Deallocate(pointer);
+    }
+
+    template<typename U>
+    bool operator==(const V8SlabAllocator<U> &) const noexcept
+    {
+        return true;
+    }
+};
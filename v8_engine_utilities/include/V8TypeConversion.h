@@ -0,0 +1,412 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <cstdint>
+#include <limits>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include "V8KeyCache.h"
+#include "V8NumericArray.h"
+#include "V8ExternalString.h"
+
+// Compile-time mapping between C++ types and V8 values. Unsupported types fail to compile instead of throwing
+// at run time. Both directions run on the engine thread inside a HandleScope and an entered context.
+// Is() tells whether a JS value has the shape of T; std::variant uses it to pick an alternative.
+template<typename T, typename Enable = void>
+struct V8Converter;
+
+// Describes the fields of a struct so V8Converter can map it to and from a plain JS object:
+//   struct Point { double x; double y; };
+//   V8_REFLECT(Point, V8_FIELD(Point, x), V8_FIELD(Point, y));
+// Fields may themselves be reflected structs, vectors, string-keyed maps, optionals or variants.
+template<typename T>
+struct V8Reflect;
+
+template<typename Class, typename Member>
+struct V8Field
+{
+    const char *name;
+    Member Class::*member;
+};
+
+template<typename Class, typename Member>
+constexpr V8Field<Class, Member> MakeV8Field(const char *name, Member Class::*member)
+{
+    return {name, member};
+}
+
+#define V8_FIELD(Type, field) MakeV8Field(#field, &Type::field)
+#define V8_REFLECT(Type, ...) \
+    template<> \
+    struct V8Reflect<Type> \
+    { \
+        static constexpr auto fields = std::make_tuple(__VA_ARGS__); \
+    }
+
+template<typename T, typename = void>
+struct IsV8Reflected : std::false_type
+{
+};
+
+template<typename T>
+struct IsV8Reflected<T, std::void_t<decltype(V8Reflect<T>::fields)> > : std::true_type
+{
+};
+
+template<>
+struct V8Converter<bool>
+{
+    static bool Is(v8::Local<v8::Value> value) { return value->IsBoolean(); }
+
+    static bool FromV8(v8::Isolate *isolate, v8::Local<v8::Context>, v8::Local<v8::Value> value)
+    {
+        return value->BooleanValue(isolate);
+    }
+
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context>, bool value)
+    {
+        return v8::Boolean::New(isolate, value);
+    }
+};
+
+template<typename T>
+struct V8Converter<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> > >
+{
+    static bool Is(v8::Local<v8::Value> value) { return value->IsNumber(); }
+
+    static T FromV8(v8::Isolate *, v8::Local<v8::Context> context, v8::Local<v8::Value> value)
+    {
+        return static_cast<T>(value->IntegerValue(context).FromMaybe(0));
+    }
+
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context>, T value)
+    {
+        if constexpr (std::is_signed_v<T> && sizeof(T) <= sizeof(int32_t))
+        {
+            return v8::Integer::New(isolate, static_cast<int32_t>(value));
+        } else if constexpr (std::is_unsigned_v<T> && sizeof(T) <= sizeof(uint32_t))
+        {
+            return v8::Integer::NewFromUnsigned(isolate, static_cast<uint32_t>(value));
+        } else
+        {
+            return v8::Number::New(isolate, static_cast<double>(value));
+        }
+    }
+};
+
+template<typename T>
+struct V8Converter<T, std::enable_if_t<std::is_floating_point_v<T> > >
+{
+    static bool Is(v8::Local<v8::Value> value) { return value->IsNumber(); }
+
+    static T FromV8(v8::Isolate *, v8::Local<v8::Context> context, v8::Local<v8::Value> value)
+    {
+        return static_cast<T>(value->NumberValue(context).FromMaybe(0.0));
+    }
+
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context>, T value)
+    {
+        return v8::Number::New(isolate, static_cast<double>(value));
+    }
+};
+
+template<>
+struct V8Converter<std::string>
+{
+    static bool Is(v8::Local<v8::Value> value) { return value->IsString(); }
+
+    static std::string FromV8(v8::Isolate *isolate, v8::Local<v8::Context>, v8::Local<v8::Value> value)
+    {
+        v8::String::Utf8Value utf8(isolate, value);
+        return *utf8 ? std::string(*utf8, utf8.length()) : std::string();
+    }
+
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context>, const std::string &value)
+    {
+        return v8::String::NewFromUtf8(isolate, value.data(), v8::NewStringType::kNormal,
+                                       static_cast<int>(value.size())).ToLocalChecked();
+    }
+};
+
+// Shared immutable text converts to JS without a copy where V8ExternalOneByteString allows it; JS only.
+template<>
+struct V8Converter<std::shared_ptr<const std::string> >
+{
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context>,
+                                     const std::shared_ptr<const std::string> &value)
+    {
+        if (!value)
+        {
+            return v8::Null(isolate);
+        }
+        return V8ExternalOneByteString::NewFromUtf8(isolate, std::shared_ptr<const char>(value, value->data()),
+                                                    value->size()).ToLocalChecked();
+    }
+};
+
+template<>
+struct V8Converter<std::shared_ptr<const std::u16string> >
+{
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context>,
+                                     const std::shared_ptr<const std::u16string> &value)
+    {
+        if (!value)
+        {
+            return v8::Null(isolate);
+        }
+        return V8ExternalTwoByteString::New(isolate, std::shared_ptr<const char16_t>(value, value->data()),
+                                            value->size()).ToLocalChecked();
+    }
+};
+
+// String literals and C strings convert to JS only.
+template<>
+struct V8Converter<const char *>
+{
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context>, const char *value)
+    {
+        return v8::String::NewFromUtf8(isolate, value).ToLocalChecked();
+    }
+};
+
+template<size_t N>
+struct V8Converter<char[N]> : V8Converter<const char *>
+{
+};
+
+template<typename T>
+struct V8Converter<std::vector<T> >
+{
+    static bool Is(v8::Local<v8::Value> value)
+    {
+        if constexpr (IsV8NumericElement<T>::value)
+        {
+            return value->IsArray() || value->IsTypedArray();
+        }
+        return value->IsArray();
+    }
+
+    // Numeric vectors take the bulk paths of V8NumericArray and only fall back to per-element conversion for
+    // arrays holding non-numbers.
+    static std::vector<T> FromV8(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value)
+    {
+        std::vector<T> result;
+        if constexpr (IsV8NumericElement<T>::value)
+        {
+            if (V8NumericArray<T>::FromTypedArray(value, result))
+            {
+                return result;
+            }
+            if (value->IsArray() && V8NumericArray<T>::FromNumberArray(context, value.As<v8::Array>(), result))
+            {
+                return result;
+            }
+            result.clear();
+        }
+        if (!value->IsArray())
+        {
+            return result;
+        }
+        const v8::Local<v8::Array> array = value.As<v8::Array>();
+        const uint32_t length = array->Length();
+        result.reserve(length);
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            v8::Local<v8::Value> element;
+            if (array->Get(context, i).ToLocal(&element))
+            {
+                result.push_back(V8Converter<T>::FromV8(isolate, context, element));
+            }
+        }
+        return result;
+    }
+
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                     const std::vector<T> &value)
+    {
+        std::vector<v8::Local<v8::Value> > elements;
+        elements.reserve(value.size());
+        for (const auto &element: value)
+        {
+            elements.push_back(V8Converter<T>::ToV8(isolate, context, element));
+        }
+        return v8::Array::New(isolate, elements.data(), elements.size());
+    }
+};
+
+// Numbers copied into a new typed array of the matching kind (Float64Array for double, ...); JS only.
+template<typename T>
+struct V8Converter<std::span<const T>, std::enable_if_t<IsV8NumericElement<T>::value> >
+{
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context>, std::span<const T> value)
+    {
+        const v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, value.size_bytes());
+        if (!value.empty())
+        {
+            std::memcpy(buffer->Data(), value.data(), value.size_bytes());
+        }
+        return V8NumericArray<T>::NewTypedArray(buffer, value.size());
+    }
+};
+
+// Shared by std::map and std::unordered_map with string keys: a plain JS object.
+template<typename Map>
+struct V8StringMapConverter
+{
+    using Mapped = typename Map::mapped_type;
+
+    static bool Is(v8::Local<v8::Value> value) { return value->IsObject() && !value->IsArray(); }
+
+    static Map FromV8(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value)
+    {
+        Map result;
+        v8::Local<v8::Array> keys;
+        if (!value->IsObject() || !value.As<v8::Object>()->GetOwnPropertyNames(context).ToLocal(&keys))
+        {
+            return result;
+        }
+        const v8::Local<v8::Object> object = value.As<v8::Object>();
+        for (uint32_t i = 0; i < keys->Length(); ++i)
+        {
+            v8::Local<v8::Value> key;
+            v8::Local<v8::Value> element;
+            if (keys->Get(context, i).ToLocal(&key) && object->Get(context, key).ToLocal(&element))
+            {
+                result.emplace(V8Converter<std::string>::FromV8(isolate, context, key),
+                               V8Converter<Mapped>::FromV8(isolate, context, element));
+            }
+        }
+        return result;
+    }
+
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context> context, const Map &value)
+    {
+        const v8::Local<v8::Object> object = v8::Object::New(isolate);
+        for (const auto &[key, element]: value)
+        {
+            object->CreateDataProperty(context, V8Converter<std::string>::ToV8(isolate, context, key).template As<v8::Name>(),
+                                       V8Converter<Mapped>::ToV8(isolate, context, element)).Check();
+        }
+        return object;
+    }
+};
+
+template<typename T>
+struct V8Converter<std::map<std::string, T> > : V8StringMapConverter<std::map<std::string, T> >
+{
+};
+
+template<typename T>
+struct V8Converter<std::unordered_map<std::string, T> > : V8StringMapConverter<std::unordered_map<std::string, T> >
+{
+};
+
+// undefined and null map to std::nullopt.
+template<typename T>
+struct V8Converter<std::optional<T> >
+{
+    static bool Is(v8::Local<v8::Value> value) { return value->IsNullOrUndefined() || V8Converter<T>::Is(value); }
+
+    static std::optional<T> FromV8(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value)
+    {
+        if (value->IsNullOrUndefined())
+        {
+            return std::nullopt;
+        }
+        return V8Converter<T>::FromV8(isolate, context, value);
+    }
+
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                     const std::optional<T> &value)
+    {
+        if (!value)
+        {
+            return v8::Null(isolate);
+        }
+        return V8Converter<T>::ToV8(isolate, context, *value);
+    }
+};
+
+// JS values pick the first alternative whose converter accepts them, else a default-constructed first one.
+template<typename... Ts>
+struct V8Converter<std::variant<Ts...> >
+{
+    static bool Is(v8::Local<v8::Value> value) { return (V8Converter<Ts>::Is(value) || ...); }
+
+    static std::variant<Ts...> FromV8(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                      v8::Local<v8::Value> value)
+    {
+        std::optional<std::variant<Ts...> > result;
+        ((!result && V8Converter<Ts>::Is(value)
+              ? (result.emplace(std::in_place_type<Ts>, V8Converter<Ts>::FromV8(isolate, context, value)), true)
+              : false) || ...);
+        return result ? std::move(*result) : std::variant<Ts...>();
+    }
+
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                     const std::variant<Ts...> &value)
+    {
+        return std::visit([&](const auto &alternative)
+        {
+            return V8Converter<std::decay_t<decltype(alternative)> >::ToV8(isolate, context, alternative);
+        }, value);
+    }
+};
+
+// Structs described with V8_REFLECT convert field by field in a single pass, using internalized field names
+// from the isolate's V8KeyCache.
+template<typename T>
+struct V8Converter<T, std::enable_if_t<IsV8Reflected<T>::value> >
+{
+    static bool Is(v8::Local<v8::Value> value) { return value->IsObject() && !value->IsArray(); }
+
+    static T FromV8(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value)
+    {
+        T result{};
+        if (!value->IsObject())
+        {
+            return result;
+        }
+        const v8::Local<v8::Object> object = value.As<v8::Object>();
+        std::apply([&](const auto &... field)
+        {
+            (ReadField(isolate, context, object, result, field), ...);
+        }, V8Reflect<T>::fields);
+        return result;
+    }
+
+    static v8::Local<v8::Value> ToV8(v8::Isolate *isolate, v8::Local<v8::Context> context, const T &value)
+    {
+        const v8::Local<v8::Object> object = v8::Object::New(isolate);
+        std::apply([&](const auto &... field)
+        {
+            (object->CreateDataProperty(context, V8KeyCache::Literal(isolate, field.name),
+                                        V8Converter<std::decay_t<decltype(value.*(field.member))> >::ToV8(
+                                            isolate, context, value.*(field.member))).Check(), ...);
+        }, V8Reflect<T>::fields);
+        return object;
+    }
+
+private:
+    template<typename Field>
+    static void ReadField(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Object> object,
+                          T &result, const Field &field)
+    {
+        v8::Local<v8::Value> element;
+        if (object->Get(context, V8KeyCache::Literal(isolate, field.name)).ToLocal(&element))
+        {
+            using Member = std::decay_t<decltype(result.*(field.member))>;
+            result.*(field.member) = V8Converter<Member>::FromV8(isolate, context, element);
+        }
+    }
+};
@@ -0,0 +1,110 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Per-engine table of persistent value handles addressed by index. Slots are reused instead of allocating a fresh
+// Global per result. Allocate/Get/Drain/Clear run on the engine thread. Release may be called from any thread:
+// it pushes the slot onto a lock-free list threaded through the slots themselves, which the engine drains in
+// batches before its next task.
+class V8ValueSlotTable
+{
+public:
+    static constexpr uint32_t kInvalidSlot = UINT32_MAX;
+
+    V8ValueSlotTable()
+        : chunks_(std::make_unique<std::unique_ptr<Slot[]>[]>(kMaxChunks))
+    {
+    }
+
+    V8ValueSlotTable(const V8ValueSlotTable &) = delete;
+    V8ValueSlotTable &operator=(const V8ValueSlotTable &) = delete;
+
+    uint32_t Allocate(v8::Isolate *isolate, v8::Local<v8::Value> value)
+    {
+        uint32_t index;
+        if (!free_slots_.empty())
+        {
+            index = free_slots_.back();
+            free_slots_.pop_back();
+        } else
+        {
+            if (size_ == kChunkSize * kMaxChunks)
+            {
+                throw std::runtime_error("V8 value slot table exhausted");
+            }
+            index = size_++;
+            // Chunks never move, so releasing threads can index them while the table grows.
+            if (!chunks_[index / kChunkSize])
+            {
+                chunks_[index / kChunkSize] = std::make_unique<Slot[]>(kChunkSize);
+            }
+        }
+        At(index).handle.Reset(isolate, value);
+        return index;
+    }
+
+    [[nodiscard]] v8::Local<v8::Value> Get(v8::Isolate *isolate, uint32_t index) const
+    {
+        return At(index).handle.Get(isolate);
+    }
+
+    void Release(uint32_t index)
+    {
+        Slot &slot = At(index);
+        uint32_t head = released_head_.load(std::memory_order_relaxed);
+        do
+        {
+            slot.next_released = head;
+        } while (!released_head_.compare_exchange_weak(head, index, std::memory_order_release,
+                                                       std::memory_order_relaxed));
+    }
+
+    void Drain()
+    {
+        uint32_t index = released_head_.exchange(kInvalidSlot, std::memory_order_acquire);
+        while (index != kInvalidSlot)
+        {
+            Slot &slot = At(index);
+            slot.handle.Reset();
+            free_slots_.push_back(index);
+            index = slot.next_released;
+        }
+    }
+
+    // Resets every handle; must run before the isolate is disposed.
+    void Clear()
+    {
+        Drain();
+        for (uint32_t i = 0; i < size_; ++i)
+        {
+            At(i).handle.Reset();
+        }
+    }
+
+private:
+    static constexpr uint32_t kChunkSize = 256;
+    static constexpr uint32_t kMaxChunks = 16384;
+
+    struct Slot
+    {
+        v8::Global<v8::Value> handle;
+        uint32_t next_released = kInvalidSlot;
+    };
+
+    std::unique_ptr<std::unique_ptr<Slot[]>[]> chunks_;
+    std::vector<uint32_t> free_slots_;
+    uint32_t size_ = 0;
+    std::atomic<uint32_t> released_head_{kInvalidSlot};
+
+    [[nodiscard]] Slot &At(uint32_t index) const
+    {
+        return chunks_[index / kChunkSize][index % kChunkSize];
+    }
+};
@@ -0,0 +1,488 @@
+//
+// Created by maxim on 18.10.2026.
+//
+#pragma once
+#include <v8.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "V8NumericArray.h"
+
+struct V8WalkOptions
+{
+    enum class CyclePolicy
+    {
+        // Fail the whole conversion.
+        Error,
+        // Emit the string "[Circular]" in place of the repeated object.
+        Placeholder,
+    };
+
+    // Nesting limit of arrays and objects.
+    size_t max_depth = 1000;
+    // Limit on the number of values emitted, containers included.
+    size_t max_nodes = std::numeric_limits<size_t>::max();
+    CyclePolicy cycle_policy = CyclePolicy::Error;
+};
+
+// Walks a V8 value depth-first with an explicit stack and reports it to Sink as a stream of events, so JSON,
+// binary formats and streaming writers share one traversal:
+//   Null() Boolean(bool) Integer(int64_t) Unsigned(uint64_t) Number(double) String(std::string_view)
+//   BeginArray(size_t count) EndArray() BeginObject(size_t count) Key(std::string_view) EndObject()
+// Counts are exact: every element and property is reported, with unrepresentable values (undefined,
+// functions, symbols) as Null(). String views are only valid during the call. A sink that also has
+// BeginString() StringPart(std::string_view) EndString() gets long string values in bounded UTF-8 slices
+// instead of one String() call, so streaming sinks never hold a whole string.
+//
+// Beyond plain arrays and objects: Dates become ISO strings, Maps objects with stringified keys, Sets and
+// typed arrays arrays, and BigInts integers, or decimal strings when they don't fit 64 bits. A repeated object
+// is only a cycle when it is its own ancestor; shared subtrees are written out each time, as JSON.stringify
+// does. Must run on the engine thread inside a HandleScope and the entered context. Throws std::runtime_error
+// on cycles (under CyclePolicy::Error), exceeded limits and JS exceptions raised by getters.
+template<typename Sink>
+class V8ValueWalker
+{
+public:
+    V8ValueWalker(v8::Isolate *isolate, v8::Local<v8::Context> context, Sink &sink,
+                  const V8WalkOptions &options = {})
+        : isolate_(isolate), context_(context), sink_(sink), options_(options)
+    {
+    }
+
+    void Walk(v8::Local<v8::Value> root)
+    {
+        const v8::TryCatch try_catch(isolate_);
+        Visit(root);
+        while (!stack_.empty())
+        {
+            // Open containers are held by Globals in their frames, so every handle of a step dies with its scope
+            // and handle usage grows with the nesting depth only, not with the size of the value
+            v8::HandleScope handle_scope(isolate_);
+            Frame &frame = stack_.back();
+            if (frame.index == frame.length)
+            {
+                Leave();
+                continue;
+            }
+            Visit(Next(frame, try_catch));
+        }
+    }
+
+private:
+    enum class Kind
+    {
+        Array,
+        Object,
+        Map,
+        Set,
+    };
+
+    struct Frame
+    {
+        Kind kind;
+        v8::Global<v8::Object> object;
+        // Property names of an Object, the flattened entries of a Map or the values of a Set.
+        v8::Global<v8::Array> items;
+        int hash;
+        uint32_t index;
+        uint32_t length;
+    };
+
+    v8::Isolate *isolate_;
+    v8::Local<v8::Context> context_;
+    Sink &sink_;
+    V8WalkOptions options_;
+    std::vector<Frame> stack_;
+    // Stack positions of the open containers by identity hash; hashes collide, so candidates are compared by
+    // identity.
+    std::unordered_multimap<int, size_t> ancestors_;
+    // Characters per string slice; longer strings go to sinks that take slices piece by piece.
+    static constexpr int kStringSlice = 16 * 1024;
+    static constexpr uint32_t kReplacementCharacter = 0xfffd;
+
+    std::string scratch_;
+    std::vector<uint8_t> latin1_;
+    std::vector<uint16_t> utf16_;
+    size_t nodes_ = 0;
+
+    static bool IsContainer(v8::Local<v8::Value> value)
+    {
+        return value->IsObject() && !value->IsDate() && !value->IsFunction() && !value->IsTypedArray();
+    }
+
+    void CountNode()
+    {
+        if (++nodes_ > options_.max_nodes)
+        {
+            throw std::runtime_error("Value exceeds the maximum number of nodes");
+        }
+    }
+
+    void Visit(v8::Local<v8::Value> value)
+    {
+        CountNode();
+        if (value->IsString())
+        {
+            VisitString(value.As<v8::String>());
+        } else if (value->IsInt32())
+        {
+            sink_.Integer(value.As<v8::Int32>()->Value());
+        } else if (value->IsNumber())
+        {
+            sink_.Number(value.As<v8::Number>()->Value());
+        } else if (value->IsBoolean())
+        {
+            sink_.Boolean(value->IsTrue());
+        } else if (value->IsBigInt())
+        {
+            VisitBigInt(value.As<v8::BigInt>());
+        } else if (value->IsDate())
+        {
+            sink_.String(Utf8(value.As<v8::Date>()->ToISOString()));
+        } else if (value->IsTypedArray())
+        {
+            VisitTypedArray(value);
+        } else if (IsContainer(value))
+        {
+            Enter(value.As<v8::Object>());
+        } else
+        {
+            sink_.Null();
+        }
+    }
+
+    void VisitString(v8::Local<v8::String> value)
+    {
+        if constexpr (requires(Sink &sink, std::string_view part)
+        {
+            sink.BeginString();
+            sink.StringPart(part);
+            sink.EndString();
+        })
+        {
+            if (value->Length() > kStringSlice)
+            {
+                sink_.BeginString();
+                WriteSlices(value);
+                sink_.EndString();
+                return;
+            }
+        }
+        sink_.String(Utf8(value));
+    }
+
+    // Reads the string kStringSlice characters at a time and hands each slice over as UTF-8. Surrogate pairs
+    // split between slices are carried over; lone surrogates become U+FFFD, as with REPLACE_INVALID_UTF8.
+    void WriteSlices(v8::Local<v8::String> value)
+    {
+        const int length = value->Length();
+        if (value->IsOneByte())
+        {
+            latin1_.resize(kStringSlice);
+            for (int start = 0; start < length; start += kStringSlice)
+            {
+                const int count = std::min(kStringSlice, length - start);
+                value->WriteOneByte(isolate_, latin1_.data(), start, count, v8::String::NO_NULL_TERMINATION);
+                scratch_.clear();
+                for (int i = 0; i < count; ++i)
+                {
+                    AppendUtf8(latin1_[i]);
+                }
+                sink_.StringPart(scratch_);
+            }
+            return;
+        }
+        utf16_.resize(kStringSlice);
+        uint32_t high_surrogate = 0;
+        for (int start = 0; start < length; start += kStringSlice)
+        {
+            const int count = std::min(kStringSlice, length - start);
+            value->Write(isolate_, utf16_.data(), start, count, v8::String::NO_NULL_TERMINATION);
+            scratch_.clear();
+            for (int i = 0; i < count; ++i)
+            {
+                const uint32_t unit = utf16_[i];
+                if (high_surrogate != 0)
+                {
+                    if (unit >= 0xdc00 && unit <= 0xdfff)
+                    {
+                        AppendUtf8(0x10000 + ((high_surrogate - 0xd800) << 10) + (unit - 0xdc00));
+                        high_surrogate = 0;
+                        continue;
+                    }
+                    AppendUtf8(kReplacementCharacter);
+                    high_surrogate = 0;
+                }
+                if (unit >= 0xd800 && unit <= 0xdbff)
+                {
+                    high_surrogate = unit;
+                } else if (unit >= 0xdc00 && unit <= 0xdfff)
+                {
+                    AppendUtf8(kReplacementCharacter);
+                } else
+                {
+                    AppendUtf8(unit);
+                }
+            }
+            sink_.StringPart(scratch_);
+        }
+        if (high_surrogate != 0)
+        {
+            scratch_.clear();
+            AppendUtf8(kReplacementCharacter);
+            sink_.StringPart(scratch_);
+        }
+    }
+
+    void AppendUtf8(uint32_t code_point)
+    {
+        if (code_point < 0x80)
+        {
+            scratch_.push_back(static_cast<char>(code_point));
+        } else if (code_point < 0x800)
+        {
+            scratch_.push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+            scratch_.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        } else if (code_point < 0x10000)
+        {
+            scratch_.push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+            scratch_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+            scratch_.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        } else
+        {
+            scratch_.push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+            scratch_.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+            scratch_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+            scratch_.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        }
+    }
+
+    void VisitBigInt(v8::Local<v8::BigInt> value)
+    {
+        bool lossless = false;
+        const int64_t signed_value = value->Int64Value(&lossless);
+        if (lossless)
+        {
+            sink_.Integer(signed_value);
+            return;
+        }
+        const uint64_t unsigned_value = value->Uint64Value(&lossless);
+        if (lossless)
+        {
+            sink_.Unsigned(unsigned_value);
+            return;
+        }
+        v8::Local<v8::String> digits;
+        if (!value->ToString(context_).ToLocal(&digits))
+        {
+            throw std::runtime_error("Failed to convert BigInt to string");
+        }
+        sink_.String(Utf8(digits));
+    }
+
+    void VisitTypedArray(v8::Local<v8::Value> value)
+    {
+        if (value->IsFloat64Array() || value->IsFloat32Array())
+        {
+            std::vector<double> elements;
+            V8NumericArray<double>::FromTypedArray(value, elements);
+            EmitElements(elements, [this](double element) { sink_.Number(element); });
+        } else if (value->IsBigUint64Array())
+        {
+            std::vector<uint64_t> elements;
+            V8NumericArray<uint64_t>::FromTypedArray(value, elements);
+            EmitElements(elements, [this](uint64_t element) { sink_.Unsigned(element); });
+        } else
+        {
+            std::vector<int64_t> elements;
+            V8NumericArray<int64_t>::FromTypedArray(value, elements);
+            EmitElements(elements, [this](int64_t element) { sink_.Integer(element); });
+        }
+    }
+
+    template<typename T, typename Emit>
+    void EmitElements(const std::vector<T> &elements, const Emit &emit)
+    {
+        CheckDepth();
+        sink_.BeginArray(elements.size());
+        for (const T &element: elements)
+        {
+            CountNode();
+            emit(element);
+        }
+        sink_.EndArray();
+    }
+
+    void CheckDepth() const
+    {
+        if (stack_.size() >= options_.max_depth)
+        {
+            throw std::runtime_error("Value exceeds the maximum nesting depth");
+        }
+    }
+
+    void Enter(v8::Local<v8::Object> object)
+    {
+        const int hash = object->GetIdentityHash();
+        const auto [first, last] = ancestors_.equal_range(hash);
+        for (auto it = first; it != last; ++it)
+        {
+            if (stack_[it->second].object == object)
+            {
+                if (options_.cycle_policy == V8WalkOptions::CyclePolicy::Placeholder)
+                {
+                    sink_.String("[Circular]");
+                    return;
+                }
+                throw std::runtime_error("Value contains a circular reference");
+            }
+        }
+        CheckDepth();
+
+        Frame frame{Kind::Object, v8::Global<v8::Object>(isolate_, object), {}, hash, 0, 0};
+        v8::Local<v8::Array> items;
+        if (object->IsArray())
+        {
+            frame.kind = Kind::Array;
+            frame.length = object.As<v8::Array>()->Length();
+            sink_.BeginArray(frame.length);
+        } else if (object->IsMap())
+        {
+            frame.kind = Kind::Map;
+            items = object.As<v8::Map>()->AsArray();
+            frame.length = items->Length();
+            sink_.BeginObject(frame.length / 2);
+        } else if (object->IsSet())
+        {
+            frame.kind = Kind::Set;
+            items = object.As<v8::Set>()->AsArray();
+            frame.length = items->Length();
+            sink_.BeginArray(frame.length);
+        } else
+        {
+            if (!object->GetOwnPropertyNames(context_).ToLocal(&items))
+            {
+                throw std::runtime_error("Failed to enumerate object properties");
+            }
+            frame.length = items->Length();
+            sink_.BeginObject(frame.length);
+        }
+        if (!items.IsEmpty())
+        {
+            frame.items.Reset(isolate_, items);
+        }
+        ancestors_.emplace(hash, stack_.size());
+        stack_.push_back(std::move(frame));
+    }
+
+    // Pops the innermost frame; its Globals release the container and its item list.
+    void Leave()
+    {
+        const Frame &frame = stack_.back();
+        if (frame.kind == Kind::Array || frame.kind == Kind::Set)
+        {
+            sink_.EndArray();
+        } else
+        {
+            sink_.EndObject();
+        }
+        const auto [first, last] = ancestors_.equal_range(frame.hash);
+        for (auto it = first; it != last; ++it)
+        {
+            if (it->second == stack_.size() - 1)
+            {
+                ancestors_.erase(it);
+                break;
+            }
+        }
+        stack_.pop_back();
+    }
+
+    // Reports the key of the next entry, if any, and returns its value.
+    v8::Local<v8::Value> Next(Frame &frame, const v8::TryCatch &try_catch)
+    {
+        const v8::Local<v8::Object> object = frame.object.Get(isolate_);
+        v8::MaybeLocal<v8::Value> child;
+        switch (frame.kind)
+        {
+            case Kind::Array:
+                child = object->Get(context_, frame.index++);
+                break;
+            case Kind::Set:
+                child = frame.items.Get(isolate_)->Get(context_, frame.index++);
+                break;
+            case Kind::Map:
+            {
+                const v8::Local<v8::Array> items = frame.items.Get(isolate_);
+                v8::Local<v8::Value> key;
+                if (!items->Get(context_, frame.index++).ToLocal(&key))
+                {
+                    Rethrow(try_catch);
+                }
+                EmitKey(key, try_catch);
+                child = items->Get(context_, frame.index++);
+                break;
+            }
+            case Kind::Object:
+            {
+                v8::Local<v8::Value> key;
+                if (!frame.items.Get(isolate_)->Get(context_, frame.index++).ToLocal(&key))
+                {
+                    Rethrow(try_catch);
+                }
+                EmitKey(key, try_catch);
+                child = object->Get(context_, key);
+                break;
+            }
+        }
+        v8::Local<v8::Value> value;
+        if (!child.ToLocal(&value))
+        {
+            Rethrow(try_catch);
+        }
+        return value;
+    }
+
+    void EmitKey(v8::Local<v8::Value> key, const v8::TryCatch &try_catch)
+    {
+        v8::Local<v8::String> name;
+        if (key->IsString())
+        {
+            name = key.As<v8::String>();
+        } else if (!key->ToString(context_).ToLocal(&name))
+        {
+            Rethrow(try_catch);
+        }
+        sink_.Key(Utf8(name));
+    }
+
+    std::string_view Utf8(v8::Local<v8::String> value)
+    {
+        const int length = value->Utf8Length(isolate_);
+        scratch_.resize(length);
+        value->WriteUtf8(isolate_, scratch_.data(), length, nullptr,
+                         v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+        return scratch_;
+    }
+
+    [[noreturn]] void Rethrow(const v8::TryCatch &try_catch) const
+    {
+        std::string message = "JavaScript exception while reading value";
+        if (try_catch.HasCaught())
+        {
+            const v8::String::Utf8Value error(isolate_, try_catch.Exception());
+            if (*error)
+            {
+                message += ": ";
+                message += *error;
+            }
+        }
+        throw std::runtime_error(message);
+    }
+};